@@ -0,0 +1,419 @@
+/*
+==================================================================================================
+Name        :   Benchmark.cpp
+Author      :   Craig O'Loughlin
+Version     :   1
+Date        :   10/16/2026
+
+Description:
+
+    Benchmark for the loading and lookup paths. Makes up a synthetic catalog of any size, writes
+    it out as a course file and times each step on it:
+
+        parse       CSVFileReader mapping the file and splitting every line into tokens
+        validate    the whole checked load (validate in Catalog.cpp): parsing on the parser threads,
+                    checking each course and inserting it into the index and graph, checkPrereqs
+        schedule    CourseSchedule, which is also where prerequisite cycles are caught
+        index       only with COURSEPLANNER_FLAT_INDEX / COURSEPLANNER_HASH_INDEX: the sort or hash
+                    index built after loading
+        search      Find of existing IDs in random order
+        iterate     one pass over every course in order
+
+    For each step it reports time, throughput, how many allocations (and bytes) it made and the
+    peak resident memory after it, as one JSON object on stdout so runs can be kept and compared.
+
+    Usage: Benchmark [--courses n] [--ids sorted|random|clustered] [--fanout n] [--depth n]
+                     [--lookups n] [--seed n] [--file path] [--keep]
+
+        --courses   how many courses (100000)
+        --ids       order of the lines in the file: sorted by ID, random, or clustered (departments
+                    together, departments and the courses in each in random order). sorted
+        --fanout    prerequisites per course, for courses past the first level (2)
+        --depth     length of the longest prerequisite chain (8). The courses are split evenly and at
+                    random into levels 0..depth, prerequisites come from the level below
+        --lookups   searches to time (as many as courses)
+        --seed      random seed, the same seed makes the same catalog (1)
+        --file      where the course file is written (benchmark_catalog.csv), deleted afterwards
+                    unless --keep
+
+    Built by CMakeLists.txt with the others (cmake --build build --target Benchmark), or by hand
+    with the program's other files, minus every other main:
+        g++ -std=c++17 -O2 -pthread Benchmark.cpp $(ls *.cpp | grep -v -e CoursePlanner -e LoadGenerator -e Benchmark -e CatalogTests)
+
+==================================================================================================
+*/
+
+#include <algorithm> // std::shuffle, std::min
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio> // std::remove
+#include <cstdlib> // malloc, free, strtoull
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+#include "Catalog.h"
+#include "CourseGraph.h"
+#include "CourseSchedule.h"
+#include "CSVFileReader.h"
+#include "SimdKernels.h"
+#include "StringArena.h"
+
+// loading steps, from Catalog.cpp
+void validate(CSVFileReader& csv, CourseIndex& into, CourseGraph& graph, StringArena& intoText);
+
+/* ---------------------------------------------------------------------------------------------
+    counting allocations: every operator new in the program goes through these
+--------------------------------------------------------------------------------------------- */
+
+static std::atomic<std::uint64_t> allocations{ 0 };
+static std::atomic<std::uint64_t> allocatedBytes{ 0 };
+
+static void* counted(std::size_t bytes) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+    void* memory = std::malloc(bytes == 0 ? 1 : bytes);
+    if (memory == nullptr) throw std::bad_alloc();
+    return memory;
+}
+
+static void* countedAligned(std::size_t bytes, std::align_val_t alignment) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+    std::size_t align = static_cast<std::size_t>(alignment);
+    std::size_t rounded = (bytes + align - 1) / align * align; // aligned_alloc wants a multiple of the alignment
+#ifdef _WIN32
+    void* memory = _aligned_malloc(rounded == 0 ? align : rounded, align);
+#else
+    void* memory = std::aligned_alloc(align, rounded == 0 ? align : rounded);
+#endif
+    if (memory == nullptr) throw std::bad_alloc();
+    return memory;
+}
+
+static void freeAligned(void* memory) {
+#ifdef _WIN32
+    _aligned_free(memory);
+#else
+    std::free(memory);
+#endif
+}
+
+void* operator new(std::size_t bytes) { return counted(bytes); }
+void* operator new[](std::size_t bytes) { return counted(bytes); }
+void* operator new(std::size_t bytes, std::align_val_t alignment) { return countedAligned(bytes, alignment); }
+void* operator new[](std::size_t bytes, std::align_val_t alignment) { return countedAligned(bytes, alignment); }
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { freeAligned(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { freeAligned(memory); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { freeAligned(memory); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept { freeAligned(memory); }
+
+// most memory the process has had resident so far, in KB
+static std::uint64_t peakResidentKB() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (! GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.PeakWorkingSetSize / 1024;
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return static_cast<std::uint64_t>(usage.ru_maxrss); // KB on Linux
+#endif
+}
+
+/* ---------------------------------------------------------------------------------------------
+    the synthetic catalog
+--------------------------------------------------------------------------------------------- */
+
+struct Options {
+    std::size_t courses = 100000;
+    std::string ids = "sorted";
+    std::size_t fanout = 2;
+    std::size_t depth = 8;
+    std::size_t lookups = 0; // 0: as many as courses
+    std::uint64_t seed = 1;
+    std::string file = "benchmark_catalog.csv";
+    bool keep = false;
+};
+
+const std::size_t COURSES_PER_DEPARTMENT = 500;
+
+// department 4 letters, then a 3 or more digit number. fixed width, so ID order is (department, number) order
+static std::string makeID(std::size_t index) {
+    std::size_t department = index / COURSES_PER_DEPARTMENT;
+    std::string ID(4, 'A');
+    for (int i = 3; i >= 0; i--) {
+        ID[i] = static_cast<char>('A' + department % 26);
+        department /= 26;
+    }
+    return ID + std::to_string(100 + index % COURSES_PER_DEPARTMENT);
+}
+
+/**
+ * @brief The course file's text. Course i has ID makeID(i) (so i is also its place in ID order) and a
+ * random level, every level the same size; its prerequisites are picked from the level below, so the longest chain is depth courses
+ * and nothing can loop. The lines are then put in the order options.ids asks for.
+ */
+static std::string makeCatalog(const Options& options) {
+
+    std::mt19937_64 random(options.seed);
+
+    std::vector<std::size_t> shuffled(options.courses);
+    for (std::size_t i = 0; i < options.courses; i++) shuffled[i] = i;
+    std::shuffle(shuffled.begin(), shuffled.end(), random);
+
+    std::vector<std::vector<std::size_t>> levels(options.depth + 1);
+    std::vector<std::size_t> levelOf(options.courses);
+    for (std::size_t place = 0; place < options.courses; place++) {
+        std::size_t i = shuffled[place];
+        levelOf[i] = place * levels.size() / options.courses;
+        levels[levelOf[i]].push_back(i);
+    }
+
+    std::vector<std::string> lines(options.courses);
+    std::vector<std::size_t> picked;
+    for (std::size_t i = 0; i < options.courses; i++) {
+        std::string& line = lines[i];
+        line = makeID(i) + ",Synthetic Course " + std::to_string(i);
+
+        if (levelOf[i] == 0 or levels[levelOf[i] - 1].empty()) continue; // empty below: more levels than courses
+        const std::vector<std::size_t>& below = levels[levelOf[i] - 1];
+        std::size_t wanted = std::min(options.fanout, below.size());
+        picked.clear();
+        while (picked.size() < wanted) { // no prerequisite twice
+            std::size_t prereq = below[random() % below.size()];
+            if (std::find(picked.begin(), picked.end(), prereq) == picked.end()) picked.push_back(prereq);
+        }
+        for (std::size_t prereq : picked) line += "," + makeID(prereq);
+    }
+
+    std::vector<std::size_t> order(options.courses);
+    for (std::size_t i = 0; i < options.courses; i++) order[i] = i;
+    if (options.ids == "random") {
+        std::shuffle(order.begin(), order.end(), random);
+    }
+    else if (options.ids == "clustered") {
+        std::size_t departments = (options.courses + COURSES_PER_DEPARTMENT - 1) / COURSES_PER_DEPARTMENT;
+        std::vector<std::size_t> departmentOrder(departments);
+        for (std::size_t d = 0; d < departments; d++) departmentOrder[d] = d;
+        std::shuffle(departmentOrder.begin(), departmentOrder.end(), random);
+
+        order.clear();
+        for (std::size_t d : departmentOrder) {
+            std::size_t first = d * COURSES_PER_DEPARTMENT;
+            std::size_t last = std::min(first + COURSES_PER_DEPARTMENT, options.courses);
+            std::size_t start = order.size();
+            for (std::size_t i = first; i < last; i++) order.push_back(i);
+            std::shuffle(order.begin() + start, order.end(), random);
+        }
+    }
+
+    std::string text;
+    for (std::size_t i : order) {
+        text += lines[i];
+        text += '\n';
+    }
+    return text;
+}
+
+/* ---------------------------------------------------------------------------------------------
+    timing
+--------------------------------------------------------------------------------------------- */
+
+// one step's numbers, taken between start() and stop()
+class Stage {
+
+    public:
+
+        explicit Stage(std::string name) : name(std::move(name)) {}
+
+        void start() {
+            allocationsBefore = allocations.load();
+            bytesBefore = allocatedBytes.load();
+            began = std::chrono::steady_clock::now();
+        }
+
+        void stop(std::uint64_t itemCount, std::uint64_t byteCount = 0) {
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - began).count();
+            allocationCount = allocations.load() - allocationsBefore;
+            allocationBytes = allocatedBytes.load() - bytesBefore;
+            items = itemCount;
+            bytes = byteCount;
+            peakKB = peakResidentKB();
+        }
+
+        void writeJson(std::ostream& out) const {
+            double perSecond = (seconds > 0) ? items / seconds : 0;
+            out << "{\"name\":\"" << name << "\",\"ms\":" << seconds * 1000 << ",\"items\":" << items
+                << ",\"items_per_second\":" << static_cast<std::uint64_t>(perSecond);
+            if (bytes != 0) out << ",\"bytes\":" << bytes << ",\"mb_per_second\":" << ((seconds > 0) ? bytes / seconds / 1e6 : 0);
+            out << ",\"allocations\":" << allocationCount << ",\"allocated_bytes\":" << allocationBytes
+                << ",\"peak_rss_kb\":" << peakKB << "}";
+        }
+
+    private:
+
+        std::string name;
+        std::chrono::steady_clock::time_point began;
+        std::uint64_t allocationsBefore = 0, bytesBefore = 0;
+        double seconds = 0;
+        std::uint64_t allocationCount = 0, allocationBytes = 0, items = 0, bytes = 0, peakKB = 0;
+};
+
+static const char* indexName() {
+#if defined(COURSEPLANNER_FLAT_INDEX)
+    return "flat";
+#elif defined(COURSEPLANNER_HASH_INDEX)
+    return "hash";
+#else
+    return "tree";
+#endif
+}
+
+static Options readOptions(int argc, char* argv[]) {
+
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--courses" and hasValue) options.courses = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--ids" and hasValue) options.ids = argv[++i];
+        else if (arg == "--fanout" and hasValue) options.fanout = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--depth" and hasValue) options.depth = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--lookups" and hasValue) options.lookups = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--seed" and hasValue) options.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--file" and hasValue) options.file = argv[++i];
+        else if (arg == "--keep") options.keep = true;
+        else throw std::runtime_error("Error: unknown option " + arg + ", see the top of Benchmark.cpp for the usage.");
+    }
+    if (options.ids != "sorted" and options.ids != "random" and options.ids != "clustered") throw std::runtime_error("Error: --ids is sorted, random or clustered.");
+    if (options.courses == 0) throw std::runtime_error("Error: --courses has to be at least 1.");
+    if (options.courses / COURSES_PER_DEPARTMENT >= 26 * 26 * 26 * 26) throw std::runtime_error("Error: too many courses for 4 letter departments.");
+    if (options.lookups == 0) options.lookups = options.courses;
+    return options;
+}
+
+int main(int argc, char* argv[]) {
+
+    try {
+        Options options = readOptions(argc, argv); // throws runtime errors
+
+        std::vector<Stage> stages;
+        {
+            std::string text = makeCatalog(options);
+            std::ofstream file(options.file, std::ios::binary);
+            if (! (file << text)) throw std::runtime_error("Error writing file: " + options.file);
+        }
+
+        // parse: the reader alone, tokens counted so the loop can't be skipped
+        std::uint64_t bytes;
+        {
+            stages.emplace_back("parse");
+            stages.back().start();
+            CSVFileReader csv(options.file); // throws runtime errors
+            std::uint64_t tokens = 0;
+            while (csv.hasLines()) {
+                csv.NextLine();
+                while (csv.hasTokens()) {
+                    csv.NextToken();
+                    tokens++;
+                }
+            }
+            bytes = csv.Contents().size();
+            stages.back().stop(tokens, bytes);
+        }
+
+        // the rest builds a catalog the way Catalog::Load does, one step at a time
+        Catalog catalog;
+        {
+            stages.emplace_back("validate");
+            stages.back().start();
+            CSVFileReader csv(options.file);
+            validate(csv, catalog.courses, catalog.graph, catalog.text); // throws runtime errors
+            csv.CloseFile();
+            stages.back().stop(options.courses, bytes);
+        }
+        {
+            stages.emplace_back("schedule");
+            stages.back().start();
+            CourseSchedule schedule(catalog.graph); // throws runtime errors
+            catalog.schedule.Swap(schedule);
+            stages.back().stop(options.courses);
+        }
+#if defined(COURSEPLANNER_FLAT_INDEX) or defined(COURSEPLANNER_HASH_INDEX)
+        {
+            stages.emplace_back("index");
+            stages.back().start();
+#if defined(COURSEPLANNER_FLAT_INDEX)
+            catalog.courses.Rebuild();
+#else
+            catalog.courses.EnableHashIndex();
+#endif
+            stages.back().stop(options.courses);
+        }
+#endif
+
+        // search: IDs made up front, in random order, so the timed loop is only the lookups
+        {
+            std::mt19937_64 random(options.seed + 1);
+            std::vector<std::string> IDs(options.lookups);
+            for (auto& ID : IDs) ID = makeID(random() % options.courses);
+
+            stages.emplace_back("search");
+            stages.back().start();
+            std::uint64_t found = 0;
+            for (const auto& ID : IDs) found += (catalog.courses.Find(std::string_view(ID)) != nullptr);
+            stages.back().stop(options.lookups);
+            if (found != options.lookups) throw std::runtime_error("Error: " + std::to_string(options.lookups - found) + " searches missed.");
+        }
+        {
+            stages.emplace_back("iterate");
+            stages.back().start();
+            std::uint64_t visited = 0, nameBytes = 0;
+            for (const auto& course : catalog.courses) {
+                visited++;
+                nameBytes += course.Name().size();
+            }
+            stages.back().stop(visited);
+            if (visited != options.courses or nameBytes == 0) throw std::runtime_error("Error: iteration visited " + std::to_string(visited) + " courses.");
+        }
+
+        if (! options.keep) std::remove(options.file.c_str());
+
+        std::ostringstream json;
+        json << "{\"config\":{\"courses\":" << options.courses << ",\"ids\":\"" << options.ids << "\",\"fanout\":" << options.fanout
+             << ",\"depth\":" << options.depth << ",\"lookups\":" << options.lookups << ",\"seed\":" << options.seed
+             << ",\"index\":\"" << indexName() << "\",\"simd\":\"" << SimdKernels::LevelName(SimdKernels::Active())
+             << "\",\"edges\":" << catalog.graph.EdgeCount() << "},\"stages\":[";
+        for (std::size_t i = 0; i < stages.size(); i++) {
+            if (i > 0) json << ",";
+            stages[i].writeJson(json);
+        }
+        json << "],\"peak_rss_kb\":" << peakResidentKB() << "}";
+        std::cout << json.str() << std::endl;
+    }
+    catch (std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
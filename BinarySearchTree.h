@@ -8,9 +8,10 @@ Date        :   04/17/2022
 Description:
 
     A custom binary tree implementation using data nodes constructed on heap. There are functions
-    for insertion and searching, standard forward iterator access as well as destructor to delete 
-    all nodes. There is no balancing available on this tree, it is up to the user at the moment
-    to ensure decent balance.
+    for insertion, removal and searching, standard forward iterator access as well as destructor to 
+    delete all nodes. The tree keeps itself balanced as a red-black tree, so insertion order no
+    longer matters (sorted input used to turn it into a linked list). Optionally a hash index on
+    the side answers exact lookups without walking the tree at all.
 
 ==================================================================================================
 */
@@ -21,21 +22,41 @@ Description:
 #include <iterator>
 #include <cstddef>
 #include <vector>
+#include <algorithm> // std::sort, std::is_sorted for bulk loading
+#include <functional> // std::less<>
+#include <stdexcept> // logic_error from CheckBalance
+#include <type_traits> // std::is_trivially_destructible, std::conditional_t
+#include <utility> // std::swap, std::forward
+
+#include "NodeArena.h"
+#include "HashIndex.h"
 
 /**
- * @brief Basic binary tree with insert and search functions. Can forward iterate all elements.
+ * @brief Red-black balanced binary tree with insert, remove and search functions. Can forward 
+ * iterate all elements.
  * 
- * Average:
+ * Worst case (height is never more than 2log(n+1)):
  * Insertion: O(logn) per item
- * Search: O(logn) per search
- * Print all in order: O(n) (at least 3n)
+ * Removal: O(logn) per item
+ * Bulk load (BuildFrom): O(n) from sorted input, O(nlogn) otherwise
+ * Search: O(logn) per search, O(1) average with the hash index enabled
+ * Range/Prefix queries: O(logn + k) for k results, streamed in order
+ * Print all in order: O(n), streamed one node at a time
  * 
- * @param T any data object. If using a custom object it must define at least operator< and operator== comparisons
+ * @param T any data object. If using a custom object it must define at least operator< comparisons
  *          against self. The object class should contain an identification field that will be used 
  *          for positioning and searching of data objects in this tree.
+ * @param Compare ordering of T, std::less<> (operator<) by default. Since std::less<> is "transparent"
+ *          Find/Remove also take plain keys, like a course ID string, as long as T defines operator<
+ *          both ways against that key type. Prefix(p) needs T::PrefixKey, a key that compares equal to
+ *          every T whose identification starts with p.
+ * @param Allocator where nodes come from, see NodeArena.h. The default NodeArena keeps nodes together
+ *          in blocks and lets Clear() drop them all at once, HeapAllocator is plain new/delete.
+ * @param Hash void (default) for no hash index. Otherwise a hash of T and of the keys Find is called
+ *          with, consistent with Compare (see Course::Hash), and EnableHashIndex() turns the index on.
  * 
  */
-template <typename T>
+template <typename T, typename Compare = std::less<>, template <typename> class Allocator = NodeArena, typename Hash = void>
 class BinarySearchTree {
 
     /* A template class is written with a generic type and is compiled to a specific type when needed,
@@ -50,37 +71,81 @@ class BinarySearchTree {
 
     private:
 
-        // private node class, contains a field to store an object and left and right nodes. 
-        // assign data during instantiation
+        // private node class, contains a field to store an object, left and right nodes and the
+        // parent node (needed to walk back up while rebalancing). the object is built right in the
+        // node from whatever arguments are given (a T to copy or move, or T's constructor arguments)
         template <typename dataT>
         struct Node {
             dataT data;
             Node* left = nullptr;
             Node* right = nullptr;
+            Node* parent = nullptr;
+            bool red = true; // new nodes are always red, fixups recolor them
 
-            Node(dataT data) {
-                this->data = data;
-            }
+            template <typename... Args>
+            explicit Node(Args&&... args) : data(std::forward<Args>(args)...) {}
         };
 
         // private fields/functions
         Node<T>* root;
-        void addNode(Node<T>* node, T data);
-        void inOrder(Node<T>* node);
-        T recursiveSearch(Node<T>* node, T searchData);
-        void deleteNodesFrom(Node<T>* node);
-
-        std::vector<Node<T>*> addressStack; // for in order element iterator //change to a root node..ll?
+        Allocator<Node<T>> nodePool;
+        void addNode(Node<T>* node, Node<T>* newNode);
+        Compare lessThan; // lessThan(a, b) is a < b
+        template <typename K>
+        Node<T>* findNode(const K& key) const;
+        void deleteNodesFrom(Node<T>* node, bool freeEach);
+        Node<T>* buildBalanced(std::vector<Node<T>*>& nodes, std::size_t low, std::size_t high, 
+                                int depth, int redDepth);
+
+        // red-black balancing helpers
+        static bool isRed(Node<T>* node) { return node != nullptr and node->red; }
+        static Node<T>* minimum(Node<T>* node);
+        void rotateLeft(Node<T>* node);
+        void rotateRight(Node<T>* node);
+        void transplant(Node<T>* oldNode, Node<T>* newNode);
+        void insertFixup(Node<T>* node);
+        void removeFixup(Node<T>* node, Node<T>* parent);
+        std::size_t checkFrom(const Node<T>* node, const Node<T>* parent) const;
+        static std::size_t heightFrom(const Node<T>* node);
+
+        /* Optional exact lookup index, pointing at the data in the nodes (nodes never move, so the
+        pointers stay good until the node is removed). Only exists at all when a Hash is given, and
+        stays empty until EnableHashIndex. Ordered things (iteration, ranges) always use the tree.
+        */
+        static constexpr bool HASHED = ! std::is_void<Hash>::value;
+        struct NoHashIndex {};
+        std::conditional_t<HASHED, HashIndex<T, Hash, Compare>, NoHashIndex> hashIndex;
+        bool hashEnabled = false;
 
     public:
 
         // accessible functions
         BinarySearchTree();
         virtual ~BinarySearchTree();
-        void Insert(T data);
-        T Search(T searchData);
+        BinarySearchTree(BinarySearchTree&& other) noexcept : BinarySearchTree() { Swap(other); }
+        BinarySearchTree& operator=(BinarySearchTree&& other) noexcept { Swap(other); return *this; }
+        void Swap(BinarySearchTree& other) noexcept;
+        void Insert(const T& data) { Emplace(data); }
+        void Insert(T&& data) { Emplace(std::move(data)); }
+        template <typename... Args>
+        const T& Emplace(Args&&... args);
+        template <typename K>
+        bool Remove(const K& key);
+        template <typename Iter>
+        std::size_t RemoveEach(Iter first, Iter last); // Remove for every key in [first, last), returns how many went
+        template <typename Iter>
+        void BuildFrom(Iter first, Iter last, bool presorted = false);
+        T Search(T searchData) const;
+        template <typename K>
+        const T* Find(const K& key) const;
         void Clear();
-        bool isEmpty();
+        bool isEmpty() const;
+        void EnableHashIndex();
+        void DisableHashIndex();
+        bool hasHashIndex() const { return hashEnabled; }
+        std::size_t HashIndexBytes() const; // memory the hash index takes, 0 when off
+        std::size_t Height() const { return heightFrom(root); } // nodes on the longest path down, never more than 2log(n+1)
+        std::size_t CheckBalance() const; // for tests: black height, throws logic_error if a red-black rule is broken
 
         struct BST_Iterator {
 
@@ -88,156 +153,708 @@ class BinarySearchTree {
 
             using iterator_category = std::forward_iterator_tag;
             using difference_type = std::ptrdiff_t;
-
-            BST_Iterator(Node<T>** ptr) { current = ptr; } // constructor
-            T operator*() const { return (*current)->data; } 
-            Node<T>** operator->() { return current; }      
-            BST_Iterator& operator++() { // define what to do when ++iter, this case pointer+1
-                current++; 
+            using value_type = T;
+            using pointer = const T*;
+            using reference = const T&;
+
+            BST_Iterator(const Node<T>* node = nullptr) { current = node; } // constructor
+            const T& operator*() const { return current->data; } // the object in the node, never a copy
+            const T* operator->() const { return &current->data; }
+
+            // define what to do when ++iter, this case step to the in order successor
+            BST_Iterator& operator++() {
+
+                if (current->right != nullptr) { 
+                    // next is the lowest node of the right subtree
+                    current = current->right;
+                    while (current->left != nullptr) current = current->left;
+                }
+                else {
+                    // otherwise climb until we come up out of a left subtree, that parent is next.
+                    // climbing out of the root means we are done (nullptr == end)
+                    const Node<T>* child = current;
+                    current = current->parent;
+                    while (current != nullptr and child == current->right) {
+                        child = current;
+                        current = current->parent;
+                    }
+                }
                 return *this; 
             }
+            BST_Iterator operator++(int) {
+                BST_Iterator before = *this;
+                ++(*this);
+                return before;
+            }
 
             // when comparing iterator objects, compare their current addresses
             friend bool operator==(const BST_Iterator& lhs, const BST_Iterator& rhs) { return lhs.current == rhs.current; }
             friend bool operator!=(const BST_Iterator& lhs, const BST_Iterator& rhs) { return lhs.current != rhs.current; }
 
             private:
-                Node<T>** current; // address of a node address 
-                                    //i think of https://i.redd.it/2a1nq2qnxkq81.png
+                const Node<T>* current; // node we are on, nullptr once past the last one
         };
 
-        BST_Iterator begin() {
+        BST_Iterator begin() const {
 
-            // O(n) operation to create this iterator but simplest to implement
             // https://www.cs.odu.edu/~zeil/cs361/latest/Public/treetraversal/index.html
 
-            /* This iterator works by opening each node on stack in order low -> high and adding each node address
-                to a vector. The vector start address is returned on begin(). Vectors are guaranteed contiguous memory
-                locations so on each iteration the starting pointer is incremented to get the next node in order.
+            /* This iterator starts at the lowest node and walks to the next node in order using the parent links
+                the tree already keeps for balancing. Nothing is collected up front, so begin() is O(logn), each ++ is
+                O(1) on average, and breaking out of a loop early costs nothing extra. Any number of iterations can
+                be going at once since all the state lives in the iterator. (It used to copy every node address into
+                a vector first, which was O(n) before the first element came out.)
 
                 The reason iterators exist is to provide uniform access to elements. The reason I added this code is for a learning,
                 I also like how objects stored here can be worked with in iterator loops like other std structures. Makes 
                 this tree feel more "official".
             */
             
-            addressStack.clear();
-            inOrder(root);  // create a vector of addresses in order
-            addressStack.push_back(nullptr);    // add a final position to vector
-            return BST_Iterator(&addressStack[0]); // return the starting address of the vector
+            const Node<T>* node = root;
+            if (node != nullptr) {
+                while (node->left != nullptr) node = node->left;
+            }
+            return BST_Iterator(node);
+
+        } //end is one past the last node, which is just an empty iterator
+        BST_Iterator end() const { return BST_Iterator(nullptr); }
+        BST_Iterator cbegin() const { return begin(); }
+        BST_Iterator cend() const { return end(); }
+
+        // a pair of iterators that works in a range based for loop, see Range/Prefix
+        struct IteratorRange {
+            BST_Iterator first;
+            BST_Iterator last;
+            BST_Iterator begin() const { return first; }
+            BST_Iterator end() const { return last; }
+            bool empty() const { return first == last; }
+        };
 
-        } //end is the final position in the address "stack" (including the empty nullspot)
-        BST_Iterator end() { return BST_Iterator(&addressStack.at(addressStack.size() - 1)); }
+        // ordered queries. each one is a single walk down the tree, then the iterators stream the results
+        template <typename K>
+        BST_Iterator LowerBound(const K& key) const; // first object not less than key
+        template <typename K>
+        BST_Iterator UpperBound(const K& key) const; // first object greater than key
+        template <typename K>
+        IteratorRange EqualRange(const K& key) const { return { LowerBound(key), UpperBound(key) }; }
+        template <typename K>
+        IteratorRange Range(const K& low, const K& high) const { // both ends included, empty if high < low
+            BST_Iterator first = LowerBound(low); // the keys can't be compared with each other directly (IDs ignore case, strings don't)
+            if (first == end() or lessThan(high, *first)) return { end(), end() };
+            return { first, UpperBound(high) };
+        }
+        template <typename P>
+        IteratorRange Prefix(const P& prefix) const { return EqualRange(typename T::PrefixKey(prefix)); }
 };
 
 // constructor
-template <typename T>
-BinarySearchTree<T>::BinarySearchTree() { 
+template <typename T, typename Compare, template <typename> class Allocator, typename Hash>
+BinarySearchTree<T, Compare, Allocator, Hash>::BinarySearchTree() { 
     root = nullptr;
 }
 
 // destructor
-template <typename T>
-BinarySearchTree<T>::~BinarySearchTree() {
-    deleteNodesFrom(root);
+template <typename T, typename Compare, template <typename> class Allocator, typename Hash>
+BinarySearchTree<T, Compare, Allocator, Hash>::~BinarySearchTree() {
+    Clear();
 }
 
 /**
- * @brief Add a data object to this tree in ordered position. Uses operator< to find position.
+ * @brief Add a data object to this tree in ordered position. Uses operator< to find position, then
+ * recolors/rotates on the way back up so the tree stays balanced. Insert(data) copies or moves data
+ * into its node, Emplace(args...) constructs the object in the node with no copy at all.
  * 
- * @param data any object class. 
+ * @param args a T, or arguments for one of T's constructors
+ * @return the object now in the tree
  */
-template <typename T>
-void BinarySearchTree<T>::Insert(T data) {
+template <typename T, typename Compare, template <typename> class Allocator, typename Hash>
+template <typename... Args>
+const T& BinarySearchTree<T, Compare, Allocator, Hash>::Emplace(Args&&... args) {
+
+    Node<T>* newNode = nodePool.Create(std::forward<Args>(args)...);
+
+    if constexpr (HASHED) {
+        if (hashEnabled) {
+            try {
+                hashIndex.Insert(&newNode->data);
+            }
+            catch (...) { // not linked into the tree yet
+                nodePool.Destroy(newNode);
+                throw;
+            }
+        }
+    }
 
     if (root == nullptr) {
-        root = new Node<T>(data);
+        root = newNode;
     }
     else {
-        addNode(root, data);
+        addNode(root, newNode);
     }
+    insertFixup(newNode);
+    return newNode->data;
 }
 
-// recursive search for the datapoint insertion location
-template <typename T>
-void BinarySearchTree<T>::addNode(Node<T>* node, T data) {
+// search for the datapoint insertion location starting at 'node' and hang newNode there.
+// a loop instead of recursion, it is the same walk down the tree either way
+template <typename T, typename Compare, template <typename> class Allocator, typename Hash>
+void BinarySearchTree<T, Compare, Allocator, Hash>::addNode(Node<T>* node, Node<T>* newNode) {
 
-    if (node == nullptr) return;
+    while (node != nullptr) {
 
-    if (data < node->data) { // courses operator< overload
+        if (lessThan(newNode->data, node->data)) { // courses operator< overload
 
-        // move down the left node and continue searching for a spot
-        if (node->left == nullptr) node->left = new Node<T>(data);
-        else addNode(node->left, data);
+            // move down the left node and continue searching for a spot
+            if (node->left == nullptr) {
+                node->left = newNode;
+                break;
+            }
+            node = node->left;
+        }
+        else {
+
+            // or, move down the right node and continue searching for a spot
+            if (node->right == nullptr) {
+                node->right = newNode;
+                break;
+            }
+            node = node->right;
+        }
+    }
+    newNode->parent = node;
+}
 
+/**
+ * @brief Remove one data object matching key from the tree. Uses operator<.
+ * 
+ * @param key data object with the identifying field filled, or just the identifying field.
+ * @return true if an object was found and removed
+ */
+template <typename T, typename Compare, template <typename> class Allocator, typename Hash>
+template <typename K>
+bool BinarySearchTree<T, Compare, Allocator, Hash>::Remove(const K& key) {
+
+    Node<T>* node = findNode(key);
+    if (node == nullptr) return false;
+
+    if constexpr (HASHED) {
+        if (hashEnabled) hashIndex.Erase(&node->data);
     }
-    else {
-        
-        // or, move down the right node and continue searching for a spot
-        if (node->right == nullptr) node->right = new Node<T>(data);
-        else addNode(node->right, data);
+
+    /* Same cases as a plain BST delete, except nodes are relinked instead of copying data between
+    them. 'replacement' is whatever ends up in the spot the removed color used to be, it can be
+    nullptr so its parent is tracked separately for the fixup.
+    */
+    Node<T>* replacement;
+    Node<T>* replacementParent;
+    bool removedRed = node->red;
+
+    if (node->left == nullptr) { // case: zero or one child (right)
+        replacement = node->right;
+        replacementParent = node->parent;
+        transplant(node, node->right);
+    }
+    else if (node->right == nullptr) { // case: one child (left)
+        replacement = node->left;
+        replacementParent = node->parent;
+        transplant(node, node->left);
+    }
+    else { // case: two children, the in order successor takes this node's place
+        Node<T>* successor = minimum(node->right);
+        removedRed = successor->red;
+        replacement = successor->right;
+
+        if (successor->parent == node) {
+            replacementParent = successor;
+        }
+        else {
+            replacementParent = successor->parent;
+            transplant(successor, successor->right);
+            successor->right = node->right;
+            successor->right->parent = successor;
+        }
+        transplant(node, successor);
+        successor->left = node->left;
+        successor->left->parent = successor;
+        successor->red = node->red;
     }
+
+    nodePool.Destroy(node);
+
+    // removing a black node shortens one side, rebalance. removing a red node changes nothing
+    if (! removedRed) removeFixup(replacement, replacementParent);
+    return true;
+}
+
+// Remove for each key in turn, O(klogn). a batch is removed the same way from either container, FlatSearchIndex does it in one pass
+template <typename T, typename Compare, template <typename> class Allocator, typename Hash>
+template <typename Iter>
+std::size_t BinarySearchTree<T, Compare, Allocator, Hash>::RemoveEach(Iter first, Iter last) {
+    std::size_t removed = 0;
+    for (; first != last; ++first) {
+        if (Remove(*first)) removed++;
+    }
+    return removed;
 }
 
-// open each node on stack in order from 'node'. Add in order to addresslist
-template <typename T>
-void BinarySearchTree<T>::inOrder(Node<T>* node) {
+// leftmost (lowest) node under 'node'
+template <typename T, typename Compare, template <typename> class Allocator, typename Hash>
+typename BinarySearchTree<T, Compare, Allocator, Hash>::template Node<T>* BinarySearchTree<T, Compare, Allocator, Hash>::minimum(Node<T>* node) {
+    while (node->left != nullptr) node = node->left;
+    return node;
+}
 
-    if (node == nullptr) return;
+/*      node                right
+        /  \               /   \
+       a   right    ->    node   c
+           /   \          /  \
+          b     c        a    b
+*/
+template <typename T, typename Compare, template <typename> class Allocator, typename Hash>
+void BinarySearchTree<T, Compare, Allocator, Hash>::rotateLeft(Node<T>* node) {
 
-    // left -> node -> right
-    inOrder(node->left);
-    addressStack.push_back(node); //add 'node' (which is an address to node) to address "stack" for iterator
-    inOrder(node->right);
+    Node<T>* right = node->right;
+    node->right = right->left;
+    if (right->left != nullptr) right->left->parent = node;
+
+    transplant(node, right);
+    right->left = node;
+    node->parent = right;
+}
+
+// mirror of rotateLeft
+template <typename T, typename Compare, template <typename> class Allocator, typename Hash>
+void BinarySearchTree<T, Compare, Allocator, Hash>::rotateRight(Node<T>* node) {
+
+    Node<T>* left = node->left;
+    node->left = left->right;
+    if (left->right != nullptr) left->right->parent = node;
+
+    transplant(node, left);
+    left->right = node;
+    node->parent = left;
+}
+
+// put newNode (can be nullptr) where oldNode hangs from its parent. oldNode's own links are untouched
+template <typename T, typename Compare, template <typename> class Allocator, typename Hash>
+void BinarySearchTree<T, Compare, Allocator, Hash>::transplant(Node<T>* oldNode, Node<T>* newNode) {
+
+    if (oldNode->parent == nullptr) root = newNode;
+    else if (oldNode == oldNode->parent->left) oldNode->parent->left = newNode;
+    else oldNode->parent->right = newNode;
+
+    if (newNode != nullptr) newNode->parent = oldNode->parent;
+}
+
+// restore the red-black rules after 'node' (red) was added as a leaf
+// https://en.wikipedia.org/wiki/Red%E2%80%93black_tree#Insertion
+template <typename T, typename Compare, template <typename> class Allocator, typename Hash>
+void BinarySearchTree<T, Compare, Allocator, Hash>::insertFixup(Node<T>* node) {
+
+    // only a problem while there are two reds in a row
+    while (node != root and isRed(node->parent)) {
+
+        Node<T>* parent = node->parent;
+        Node<T>* grandparent = parent->parent; // parent is red so it can't be the root
+
+        if (parent == grandparent->left) {
+            Node<T>* uncle = grandparent->right;
+
+            if (isRed(uncle)) { // case: red uncle, push the red up and check again from there
+                parent->red = false;
+                uncle->red = false;
+                grandparent->red = true;
+                node = grandparent;
+            }
+            else {
+                if (node == parent->right) { // case: inner child, rotate into an outer child
+                    node = parent;
+                    rotateLeft(node);
+                    parent = node->parent;
+                }
+                // case: outer child, one rotation at the grandparent finishes it
+                parent->red = false;
+                grandparent->red = true;
+                rotateRight(grandparent);
+            }
+        }
+        else { // mirror of the above
+            Node<T>* uncle = grandparent->left;
+
+            if (isRed(uncle)) {
+                parent->red = false;
+                uncle->red = false;
+                grandparent->red = true;
+                node = grandparent;
+            }
+            else {
+                if (node == parent->left) {
+                    node = parent;
+                    rotateRight(node);
+                    parent = node->parent;
+                }
+                parent->red = false;
+                grandparent->red = true;
+                rotateLeft(grandparent);
+            }
+        }
+    }
+    root->red = false;
 }
 
+// restore the red-black rules after a black node was removed above 'node'. node may be nullptr
+// (an empty leaf) which is why its parent is passed along
+// https://en.wikipedia.org/wiki/Red%E2%80%93black_tree#Removal
+template <typename T, typename Compare, template <typename> class Allocator, typename Hash>
+void BinarySearchTree<T, Compare, Allocator, Hash>::removeFixup(Node<T>* node, Node<T>* parent) {
+
+    // 'node' is short one black compared to its sibling until this loop is done
+    while (node != root and ! isRed(node)) {
+
+        if (node == parent->left) {
+            Node<T>* sibling = parent->right; // can't be empty, that side has the extra black
 
-/** @brief Get the specified object from the tree. Uses operator== and operator<.
+            if (isRed(sibling)) { // case: red sibling, rotate so the sibling is black
+                sibling->red = false;
+                parent->red = true;
+                rotateLeft(parent);
+                sibling = parent->right;
+            }
+
+            if (! isRed(sibling->left) and ! isRed(sibling->right)) { // case: take a black from both sides, move up
+                sibling->red = true;
+                node = parent;
+                parent = node->parent;
+            }
+            else {
+                if (! isRed(sibling->right)) { // case: only the inner nephew is red, rotate it outside
+                    sibling->left->red = false;
+                    sibling->red = true;
+                    rotateRight(sibling);
+                    sibling = parent->right;
+                }
+                // case: outer nephew red, one rotation at the parent finishes it
+                sibling->red = parent->red;
+                parent->red = false;
+                sibling->right->red = false;
+                rotateLeft(parent);
+                node = root;
+            }
+        }
+        else { // mirror of the above
+            Node<T>* sibling = parent->left;
+
+            if (isRed(sibling)) {
+                sibling->red = false;
+                parent->red = true;
+                rotateRight(parent);
+                sibling = parent->left;
+            }
+
+            if (! isRed(sibling->left) and ! isRed(sibling->right)) {
+                sibling->red = true;
+                node = parent;
+                parent = node->parent;
+            }
+            else {
+                if (! isRed(sibling->left)) {
+                    sibling->right->red = false;
+                    sibling->red = true;
+                    rotateLeft(sibling);
+                    sibling = parent->left;
+                }
+                sibling->red = parent->red;
+                parent->red = false;
+                sibling->left->red = false;
+                rotateRight(parent);
+                node = root;
+            }
+        }
+    }
+    if (node != nullptr) node->red = false;
+}
+
+/** @brief Get the specified object from the tree. Uses operator<.
  * @param searchData data object with the identifying field filled.
  * @return A copy of the data object if found else searchData
  */
-template <typename T>
-T BinarySearchTree<T>::Search(T searchData) { //Get
-    return recursiveSearch(root, searchData);
+template <typename T, typename Compare, template <typename> class Allocator, typename Hash>
+T BinarySearchTree<T, Compare, Allocator, Hash>::Search(T searchData) const { //Get
+    const T* found = Find(searchData);
+    return (found != nullptr) ? *found : searchData;
+}
+
+/** @brief Look up an object in place, no copies made. Uses operator<.
+ * @param key anything T can be compared against with the tree's Compare, e.g. a Course or an ID string
+ * @return pointer to the object in the tree if found else nullptr. Valid until that object is removed
+ */
+template <typename T, typename Compare, template <typename> class Allocator, typename Hash>
+template <typename K>
+const T* BinarySearchTree<T, Compare, Allocator, Hash>::Find(const K& key) const {
+    if constexpr (HASHED) {
+        if (hashEnabled) return hashIndex.Find(key, lessThan);
+    }
+    const Node<T>* node = findNode(key);
+    return (node != nullptr) ? &node->data : nullptr;
+}
+
+/** @brief Where key would go in the tree: the first object that is not less than it (the matching
+ * object if there is one). Like std::lower_bound.
+ * @return iterator to that object, end() if every object is less than key
+ */
+template <typename T, typename Compare, template <typename> class Allocator, typename Hash>
+template <typename K>
+typename BinarySearchTree<T, Compare, Allocator, Hash>::BST_Iterator BinarySearchTree<T, Compare, Allocator, Hash>::LowerBound(const K& key) const {
+
+    // every time we go left the node is a candidate, the last candidate is the answer
+    const Node<T>* node = root;
+    const Node<T>* bound = nullptr;
+    while (node != nullptr) {
+        if (lessThan(node->data, key)) node = node->right;
+        else {
+            bound = node;
+            node = node->left;
+        }
+    }
+    return BST_Iterator(bound);
+}
+
+/** @brief The first object greater than key, so everything matching key comes before it. Like std::upper_bound.
+ * @return iterator to that object, end() if no object is greater than key
+ */
+template <typename T, typename Compare, template <typename> class Allocator, typename Hash>
+template <typename K>
+typename BinarySearchTree<T, Compare, Allocator, Hash>::BST_Iterator BinarySearchTree<T, Compare, Allocator, Hash>::UpperBound(const K& key) const {
+
+    const Node<T>* node = root;
+    const Node<T>* bound = nullptr;
+    while (node != nullptr) {
+        if (lessThan(key, node->data)) {
+            bound = node;
+            node = node->left;
+        }
+        else node = node->right;
+    }
+    return BST_Iterator(bound);
 }
 
-template <typename T>
-T BinarySearchTree<T>::recursiveSearch(Node<T>* node, T searchData) {
+// find the node matching key, nullptr if not found. a loop down the tree, no recursion and nothing copied
+template <typename T, typename Compare, template <typename> class Allocator, typename Hash>
+template <typename K>
+typename BinarySearchTree<T, Compare, Allocator, Hash>::template Node<T>* BinarySearchTree<T, Compare, Allocator, Hash>::findNode(const K& key) const {
 
     /*--- it is up to the object to define what field is compared ---*/
 
-    if (node == nullptr) return searchData; // case: not found
-    if (node->data == searchData) return node->data; // case: found
+    Node<T>* node = root;
+    while (node != nullptr) {
+        if (lessThan(key, node->data)) node = node->left;
+        else if (lessThan(node->data, key)) node = node->right;
+        else return node; // case: found, neither is less than the other
+    }
+    return nullptr; // case: not found
+}
+
+/**
+ * @brief Replace the contents of this tree with the objects in [first, last). The objects are sorted
+ * once (skipped if they already are, or if the caller says so with presorted) and the tree is then
+ * built top down from the middle of each run, which is linear and perfectly balanced. Much cheaper
+ * than calling Insert n times.
+ * 
+ * @param first, last any forward iterator range of T
+ * @param presorted true if the range is known to be in operator< order already
+ */
+template <typename T, typename Compare, template <typename> class Allocator, typename Hash>
+template <typename Iter>
+void BinarySearchTree<T, Compare, Allocator, Hash>::BuildFrom(Iter first, Iter last, bool presorted) {
+
+    Clear();
 
-    // the search continues
-    if (searchData < node->data) {
-        return recursiveSearch(node->left, searchData);
-    } else {
-        return recursiveSearch(node->right, searchData);
+    // make the nodes up front and sort those, so the data is only copied once
+    std::vector<Node<T>*> nodes;
+    try {
+        for (; first != last; ++first) nodes.push_back(nodePool.Create(*first));
+    }
+    catch (...) { // nothing is linked yet, give back what was made
+        for (auto node : nodes) nodePool.Destroy(node);
+        throw;
+    }
+
+    auto nodeLess = [this](Node<T>* lhs, Node<T>* rhs) { return lessThan(lhs->data, rhs->data); };
+    if (! presorted and ! std::is_sorted(nodes.begin(), nodes.end(), nodeLess)) {
+        std::sort(nodes.begin(), nodes.end(), nodeLess);
+    }
+
+    /* Splitting at the middle fills every level except maybe the last one. Leave all nodes black
+    except the ones on that partly filled bottom level, which are colored red, and every path 
+    from the root then sees the same number of black nodes.
+    */
+    int fullLevels = 0;
+    while ((std::size_t(2) << fullLevels) <= nodes.size() + 1) fullLevels++; // floor(log2(n + 1))
+
+    root = buildBalanced(nodes, 0, nodes.size(), 0, fullLevels);
+
+    if constexpr (HASHED) {
+        if (hashEnabled) {
+            hashIndex.Reserve(nodes.size());
+            for (auto node : nodes) hashIndex.Insert(&node->data);
+        }
     }
 }
 
-/** @brief Empty the tree of all contents.
+// link nodes[low, high) into a subtree under its middle node, return the subtree root
+template <typename T, typename Compare, template <typename> class Allocator, typename Hash>
+typename BinarySearchTree<T, Compare, Allocator, Hash>::template Node<T>* BinarySearchTree<T, Compare, Allocator, Hash>::buildBalanced(
+        std::vector<Node<T>*>& nodes, std::size_t low, std::size_t high, int depth, int redDepth) {
+
+    if (low >= high) return nullptr;
+
+    std::size_t middle = low + (high - low) / 2;
+    Node<T>* node = nodes[middle];
+    node->red = (depth == redDepth);
+
+    node->left = buildBalanced(nodes, low, middle, depth + 1, redDepth);
+    if (node->left != nullptr) node->left->parent = node;
+
+    node->right = buildBalanced(nodes, middle + 1, high, depth + 1, redDepth);
+    if (node->right != nullptr) node->right->parent = node;
+
+    return node;
+}
+
+/** @brief Empty the tree of all contents. With NodeArena the memory goes back in one step (for data that
+ * needs a destructor, like strings, the nodes are still visited once to run it, but nothing is freed one at a time).
  */
-template <typename T>
-void BinarySearchTree<T>::Clear() {
-    deleteNodesFrom(root);
+template <typename T, typename Compare, template <typename> class Allocator, typename Hash>
+void BinarySearchTree<T, Compare, Allocator, Hash>::Clear() {
+
+    if constexpr (Allocator<Node<T>>::releasesAll) {
+        if constexpr (! std::is_trivially_destructible<T>::value) deleteNodesFrom(root, false);
+        nodePool.Release();
+    }
+    else {
+        deleteNodesFrom(root, true);
+    }
     root = nullptr;
+
+    if constexpr (HASHED) hashIndex.Clear(); // stays enabled
 }
 
-// get all node addresses and delete
-template <typename T>
-void BinarySearchTree<T>::deleteNodesFrom(Node<T>* node) {
+/* Destroy every node under 'node' (and itself), freeing each one too if freeEach. Works without recursion so
+a tall tree can't overflow the stack: go down to any leaf, unhook it from its parent, destroy it and continue from
+the parent until we climb back out above 'node'.
+*/
+template <typename T, typename Compare, template <typename> class Allocator, typename Hash>
+void BinarySearchTree<T, Compare, Allocator, Hash>::deleteNodesFrom(Node<T>* node, bool freeEach) {
+
     if (node == nullptr) return;
-    deleteNodesFrom(node->left);
-    deleteNodesFrom(node->right);
-    delete node;
+    Node<T>* stop = node->parent;
+
+    while (node != stop) {
+        if (node->left != nullptr) node = node->left;
+        else if (node->right != nullptr) node = node->right;
+        else {
+            Node<T>* parent = node->parent;
+            if (parent != nullptr) {
+                if (parent->left == node) parent->left = nullptr;
+                else parent->right = nullptr;
+            }
+
+            if (freeEach) nodePool.Destroy(node);
+            else node->~Node();
+            node = parent;
+        }
+    }
+}
+
+/** @brief Trade contents with another tree in O(1), nothing is copied. Handy to build a tree off to the side
+ * and then put it in place all at once.
+ */
+template <typename T, typename Compare, template <typename> class Allocator, typename Hash>
+void BinarySearchTree<T, Compare, Allocator, Hash>::Swap(BinarySearchTree& other) noexcept {
+    std::swap(root, other.root);
+    std::swap(nodePool, other.nodePool);
+    std::swap(lessThan, other.lessThan);
+    if constexpr (HASHED) hashIndex.Swap(other.hashIndex);
+    std::swap(hashEnabled, other.hashEnabled);
+}
+
+/** @brief Start keeping the hash index (built from what is in the tree now, then kept up to date by
+ * Insert, Remove, BuildFrom and Clear) and use it for Find/Search. Only for trees with a Hash.
+ */
+template <typename T, typename Compare, template <typename> class Allocator, typename Hash>
+void BinarySearchTree<T, Compare, Allocator, Hash>::EnableHashIndex() {
+
+    static_assert(HASHED, "EnableHashIndex needs a Hash template argument");
+    if (hashEnabled) return;
+
+    std::size_t count = 0;
+    for (auto iter = begin(); iter != end(); ++iter) count++;
+    try {
+        hashIndex.Reserve(count);
+        for (auto iter = begin(); iter != end(); ++iter) hashIndex.Insert(iter.operator->());
+    }
+    catch (...) { // stay off rather than half built
+        hashIndex.Clear();
+        throw;
+    }
+    hashEnabled = true;
+}
+
+/** @brief Drop the hash index and its memory, lookups walk the tree again.
+ */
+template <typename T, typename Compare, template <typename> class Allocator, typename Hash>
+void BinarySearchTree<T, Compare, Allocator, Hash>::DisableHashIndex() {
+    if constexpr (HASHED) hashIndex.Clear();
+    hashEnabled = false;
+}
+
+template <typename T, typename Compare, template <typename> class Allocator, typename Hash>
+std::size_t BinarySearchTree<T, Compare, Allocator, Hash>::HashIndexBytes() const {
+    if constexpr (HASHED) return hashIndex.Bytes();
+    else return 0;
 }
 
 /** @brief Is it?
  */
-template <typename T>
-bool BinarySearchTree<T>::isEmpty() {
+template <typename T, typename Compare, template <typename> class Allocator, typename Hash>
+bool BinarySearchTree<T, Compare, Allocator, Hash>::isEmpty() const {
     return root == nullptr;
 }
 
+/**
+ * @brief Walk the whole tree checking everything the balancing relies on: the root is black, no red
+ * node has a red child, every path down has as many black nodes, parent links point back up and the
+ * objects are in order. O(n), it's for tests (and for hunting bugs in the rotations).
+ *
+ * @return the number of black nodes on every path from the root down
+ */
+template <typename T, typename Compare, template <typename> class Allocator, typename Hash>
+std::size_t BinarySearchTree<T, Compare, Allocator, Hash>::CheckBalance() const {
+    if (isRed(root)) throw std::logic_error("Error: the root is red.");
+    return checkFrom(root, nullptr);
+}
+
+// black height of the subtree at node, checking its rules on the way (see CheckBalance)
+template <typename T, typename Compare, template <typename> class Allocator, typename Hash>
+std::size_t BinarySearchTree<T, Compare, Allocator, Hash>::checkFrom(const Node<T>* node, const Node<T>* parent) const {
+
+    if (node == nullptr) return 1; // the empty leaves count as black
+    if (node->parent != parent) throw std::logic_error("Error: a node's parent link is wrong.");
+    if (node->red and (isRed(node->left) or isRed(node->right))) throw std::logic_error("Error: a red node has a red child.");
+    if ((node->left != nullptr and lessThan(node->data, node->left->data)) or
+        (node->right != nullptr and lessThan(node->right->data, node->data))) {
+        throw std::logic_error("Error: a node is on the wrong side of its parent.");
+    }
+
+    std::size_t left = checkFrom(node->left, node);
+    if (checkFrom(node->right, node) != left) throw std::logic_error("Error: two paths down have different black heights.");
+    return left + (node->red ? 0 : 1);
+}
+
+template <typename T, typename Compare, template <typename> class Allocator, typename Hash>
+std::size_t BinarySearchTree<T, Compare, Allocator, Hash>::heightFrom(const Node<T>* node) {
+    if (node == nullptr) return 0;
+    return 1 + std::max(heightFrom(node->left), heightFrom(node->right));
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,113 @@
+/*
+==================================================================================================
+Name        :   Bitset.h
+Author      :   Craig O'Loughlin
+Version     :   1
+Date        :   10/16/2026
+
+Description:
+
+    A set of small integers (course handles) stored as one bit each, sized at runtime. Set
+    operations go 64 bits at a time, so comparing two sets of a few thousand courses is a few
+    dozen word operations.
+
+==================================================================================================
+*/
+
+#ifndef BITSET_H
+#define BITSET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/**
+ * @brief Dynamically sized bitset. The word loops are kept branch free (the subset test only checks
+ * for an early exit once per block of words) so the compiler can turn them into vector instructions.
+ *
+ * Bitset taken(graph.size());
+ * taken.Set(handle);
+ * if (required.IsSubsetOf(taken)) ...
+ */
+class Bitset {
+
+    public:
+
+        Bitset() = default;
+        explicit Bitset(std::size_t bits) : bits(bits), words((bits + 63) / 64, 0) {}
+
+        std::size_t size() const { return bits; }
+        std::size_t Bytes() const { return words.size() * sizeof(std::uint64_t); }
+
+        void Set(std::size_t bit) { words[bit / 64] |= std::uint64_t(1) << (bit % 64); }
+        void Reset(std::size_t bit) { words[bit / 64] &= ~(std::uint64_t(1) << (bit % 64)); }
+        bool Test(std::size_t bit) const { return (words[bit / 64] >> (bit % 64)) & 1; }
+
+        // add every bit of other (same size)
+        Bitset& operator|=(const Bitset& other) {
+            for (std::size_t i = 0; i < words.size(); i++) words[i] |= other.words[i];
+            return *this;
+        }
+
+        // every bit set here is also set in other (same size)
+        bool IsSubsetOf(const Bitset& other) const {
+            const std::size_t BLOCK = 8; // 512 bits
+            std::size_t i = 0;
+            for (; i + BLOCK <= words.size(); i += BLOCK) {
+                std::uint64_t missing = 0;
+                for (std::size_t j = i; j < i + BLOCK; j++) missing |= words[j] & ~other.words[j];
+                if (missing != 0) return false;
+            }
+            std::uint64_t missing = 0;
+            for (; i < words.size(); i++) missing |= words[i] & ~other.words[i];
+            return missing == 0;
+        }
+
+        std::size_t Count() const {
+            std::size_t count = 0;
+            for (std::uint64_t word : words) count += popCount(word);
+            return count;
+        }
+
+        // call visit(bit) for every set bit, lowest first
+        template <typename Visit>
+        void ForEach(Visit visit) const {
+            for (std::size_t i = 0; i < words.size(); i++) {
+                std::uint64_t word = words[i];
+                while (word != 0) {
+                    visit(i * 64 + lowestBit(word));
+                    word &= word - 1; // clear the lowest set bit
+                }
+            }
+        }
+
+    private:
+
+        std::size_t bits = 0;
+        std::vector<std::uint64_t> words;
+
+        // single instructions on anything recent
+        static std::size_t popCount(std::uint64_t word) {
+#ifdef _MSC_VER
+            return static_cast<std::size_t>(__popcnt64(word));
+#else
+            return static_cast<std::size_t>(__builtin_popcountll(word));
+#endif
+        }
+
+        static std::size_t lowestBit(std::uint64_t word) { // word can't be 0
+#ifdef _MSC_VER
+            unsigned long bit;
+            _BitScanForward64(&bit, word);
+            return bit;
+#else
+            return static_cast<std::size_t>(__builtin_ctzll(word));
+#endif
+        }
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,85 @@
+/*
+==================================================================================================
+Name        :   BoundedQueue.h
+Author      :   Craig O'Loughlin
+Version     :   1
+Date        :   10/16/2026
+
+Description:
+
+    First in first out queue between threads with a fixed capacity. A producer that gets too far
+    ahead blocks until the consumer catches up, so a pipeline built on these never holds more
+    than a few items in flight no matter how big the input is.
+
+==================================================================================================
+*/
+
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+/**
+ * @brief Blocking queue with a capacity. Close() ends the stream: pushes start failing and pops
+ * return whatever is left, then fail.
+ *
+ * producer: while (...) if (! queue.Push(std::move(item))) break;   then queue.Close()
+ * consumer: while (queue.Pop(item)) ...
+ */
+template <typename T>
+class BoundedQueue {
+
+    private:
+
+        std::deque<T> items;
+        std::size_t capacity;
+        bool closed = false;
+
+        std::mutex lock;
+        std::condition_variable notFull;
+        std::condition_variable notEmpty;
+
+    public:
+
+        explicit BoundedQueue(std::size_t capacity) : capacity(capacity == 0 ? 1 : capacity) {}
+
+        BoundedQueue(const BoundedQueue&) = delete;
+        BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+        // wait for room and add item. false (and item left untouched) if the queue was closed
+        bool Push(T&& item) {
+            std::unique_lock<std::mutex> guard(lock);
+            notFull.wait(guard, [this] { return closed or items.size() < capacity; });
+            if (closed) return false;
+
+            items.push_back(std::move(item));
+            notEmpty.notify_one();
+            return true;
+        }
+
+        // wait for an item and move it into 'item'. false once the queue is closed and empty
+        bool Pop(T& item) {
+            std::unique_lock<std::mutex> guard(lock);
+            notEmpty.wait(guard, [this] { return closed or ! items.empty(); });
+            if (items.empty()) return false;
+
+            item = std::move(items.front());
+            items.pop_front();
+            notFull.notify_one();
+            return true;
+        }
+
+        // no more pushes. wakes everyone waiting
+        void Close() {
+            std::lock_guard<std::mutex> guard(lock);
+            closed = true;
+            notFull.notify_all();
+            notEmpty.notify_all();
+        }
+};
+
+#endif
\ No newline at end of file
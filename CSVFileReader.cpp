@@ -1,79 +1,163 @@
 #include "CSVFileReader.h"
 
+#include <algorithm> // std::min
+#include <cstring> // memchr
+#include <stdexcept>
+
 /* Fun fact, I lost the original code for this on Friday night while doing a cleanup of my c drive :(
 */
 
-// constructor. open filepath and initalize line count
-CSVFileReader::CSVFileReader(std::string filePath) {
+// constructor. map the file at filepath and initalize line count. throw error if there was an issue.
+CSVFileReader::CSVFileReader(std::string filePath) : filePath(filePath), file(filePath) {
 
-    this->filePath = filePath;
-    openFileStream();
-    linesAvail = true;
-    currLineNumber = 0;
+    if (file.size() == 0) throw std::runtime_error("Error: Empty file.");
+    file.AdviseSequential(); // we only ever read front to back
 
+    textStart = file.data();
+    fileEnd = file.data() + file.size();
+    tokensAvail = false;
+    Reset();
 }
 
-// open the filestream at the designated filepath. throw error if there was an issue.
-void CSVFileReader::openFileStream() {
-    inFS.open(filePath);
-    if (! inFS.is_open()) throw std::runtime_error("Error opening file: " + filePath);
-    if (inFS.peek() == EOF) throw std::runtime_error("Error: Empty file.");
+// constructor for text that is already in memory, no file involved. the text has to outlive the reader
+CSVFileReader::CSVFileReader(std::string_view text) {
+
+    textStart = text.data();
+    fileEnd = text.data() + text.size();
+    tokensAvail = false;
+    Reset();
 }
 
 /**
- * @brief Point the parser state at the next available line in the file. If no more lines, 
+ * @brief Point the parser state at the next available line in the file. If no more lines,
  * set the hasLines state to false.
  */
 void CSVFileReader::NextLine() {
 
-    std::string line;
-    if (! inFS.eof()) {
+    tokensAvail = false;
+    skipRestOfLine();
 
-        getline(inFS, line);
-        currLineNumber++;    
-        currentLine = std::stringstream(line);
-        tokensAvail = (line == "") ? false : true; //empty lines dont have tokens
-    }
+    if (nextLine < fileEnd) {
 
-    if (inFS.eof()) {  //since it can now be the eof after reading the last line, check again
-        linesAvail = false;
+        nextToken = nextLine;
+        currLineNumber++;
+
+        // empty lines dont have tokens. those are known right away, so is where the next line starts
+        const char* text = nextToken;
+        if (text < fileEnd and *text == '\r' and (text + 1 == fileEnd or text[1] == '\n')) text++; // windows line ending
+        if (text == fileEnd or *text == '\n') {
+            nextLine = (text == fileEnd) ? fileEnd : text + 1;
+            return;
+        }
+
+        tokensAvail = true;
+        lineScanned = false; // found by the last NextToken on this line
     }
 }
 
+// are there lines after the current one?
+bool CSVFileReader::hasLines() {
+    skipRestOfLine();
+    return nextLine < fileEnd;
+}
+
 /**
  * @brief Get the next token at the current line up to a comma or the end of the line.
  * If at the end of the line, set hasTokens state to false.
- * 
- * @return C++ string copy of the next token in the file.
+ *
+ * @return view of the next token, pointing into the mapped file.
  */
-std::string CSVFileReader::NextToken() {
+std::string_view CSVFileReader::NextToken() {
 
-    /* on each loop run get the character. by default add that character to the
-     token. if the character is ',' or EOL, return the token.
+    /* find the next comma or newline, whichever comes first. the token is everything up to it. a comma
+     means more tokens follow, a newline (or the end of the file) means that was the last one and the next
+     line starts right after it. So each char of the file is looked at once, by the vector compares.
 
-     The place in the currentLine is saved in the object state for the next call.
+     The place in the current line is saved in the object state for the next call.
     */
 
-    std::string token;
-    while (! currentLine.eof()) {
-        nextChar = currentLine.get();
-
-        switch (nextChar) {
-            case EOF:
-                tokensAvail = false; // intentional fall thru
-            case ',':
-                return token;
-            default:
-                token.push_back(nextChar);
-                break;
-        }
+    if (! tokensAvail) return std::string_view(); // case: ""
+
+    const char* start = nextToken;
+    const char* stop = nextDelimiter(start);
+
+    if (stop != fileEnd and *stop == ',') {
+        nextToken = stop + 1;
+        return std::string_view(start, stop - start);
     }
-    return token; // case: ""
+
+    tokensAvail = false;
+    lineScanned = true;
+    nextLine = (stop == fileEnd) ? fileEnd : stop + 1;
+    nextToken = stop;
+
+    if (stop > start and *(stop - 1) == '\r') stop--; // windows line ending
+    return std::string_view(start, stop - start);
 }
 
 // point the parser back to the top of the file if needed
 void CSVFileReader::Reset() {
-    inFS.seekg(0);
+    nextLine = nextToken = maskStart = textStart;
+    maskLength = 0; // nothing marked yet
+    lineScanned = true;
+    tokensAvail = false;
     currLineNumber = 0;
-    linesAvail = true;
 }
+
+// unmap the file. tokens handed out before this are no longer valid
+void CSVFileReader::CloseFile() {
+    file.Close();
+    textStart = nextLine = fileEnd = nextToken = maskStart = nullptr;
+    maskLength = 0;
+    lineScanned = true;
+    tokensAvail = false;
+}
+
+// if the current line's tokens weren't all read, find where it ends (its newline is the next one)
+void CSVFileReader::skipRestOfLine() {
+    if (lineScanned) return;
+    const char* newline = static_cast<const char*>(std::memchr(nextToken, '\n', fileEnd - nextToken));
+    nextLine = (newline != nullptr) ? newline + 1 : fileEnd;
+    lineScanned = true;
+}
+
+/* The first comma or newline at or after 'from', fileEnd if there are none.
+
+SimdKernels::MatchMasks marks every comma and newline in the next few hundred bytes as bits, 64 to an
+integer. Tokens are short, so that covers many of them: each call just masks off the bits before 'from'
+and takes the lowest one left. Only when the marked bytes run out are the next ones marked.
+*/
+const char* CSVFileReader::nextDelimiter(const char* from) {
+
+    std::size_t offset = from - maskStart;
+    if (from >= maskStart and offset < maskLength) { // case: usually the next one is in the same 64 bytes
+        std::uint64_t ahead = masks[offset / 64] & (~std::uint64_t(0) << (offset % 64));
+        if (ahead != 0) return maskStart + (offset / 64) * 64 + SimdKernels::LowestBit(ahead);
+    }
+    return nextDelimiterSlow(from);
+}
+
+// the rest of nextDelimiter, past the 64 bytes 'from' is in
+const char* CSVFileReader::nextDelimiterSlow(const char* from) {
+
+    const std::size_t WORDS = SimdKernels::MASK_BYTES / 64;
+
+    while (true) {
+        if (from < maskStart or static_cast<std::size_t>(from - maskStart) >= maskLength) { // case: past the marked bytes, mark from here
+            maskStart = from;
+            maskLength = std::min<std::size_t>(SimdKernels::MASK_BYTES, fileEnd - from);
+            if (maskLength == 0) return fileEnd;
+            SimdKernels::MatchMasks(from, maskLength, ',', '\n', masks);
+        }
+
+        std::size_t offset = from - maskStart;
+        std::uint64_t ahead = masks[offset / 64] & (~std::uint64_t(0) << (offset % 64));
+        if (ahead != 0) return maskStart + (offset / 64) * 64 + SimdKernels::LowestBit(ahead);
+        for (std::size_t word = offset / 64 + 1; word < WORDS; word++) {
+            if (masks[word] != 0) return maskStart + word * 64 + SimdKernels::LowestBit(masks[word]);
+        }
+
+        if (maskStart + maskLength == fileEnd) return fileEnd;
+        from = maskStart + maskLength;
+    }
+}
\ No newline at end of file
@@ -2,15 +2,19 @@
 ==================================================================================================
 Name        :   CSVFileReader.h
 Author      :   Craig O'Loughlin
-Version     :   1
+Version     :   2
 Date        :   04/17/2022
 
 Description:
 
-    Roll a filestream, iostream, and stringstream into a single object to parse an input file
-    piece by piece per function call. The thought behind this was to be able to read data
-    while validating instead of reading the entirety of file into memory first. If I were to 
-    redo this project I might just use getline(in, line, ',') functionality instead.
+    Parse an input file piece by piece per function call. The thought behind this was to be able
+    to read data while validating instead of reading the entirety of file into memory first.
+
+    Version 1 rolled a filestream and a stringstream together and built every token one char at
+    a time. Version 2 maps the file into memory instead (see MappedFile.h) and hands out tokens
+    as string_views pointing straight into the mapping, so no line or token is ever copied.
+    Lines and tokens are found in the same single scan for commas and newlines, which marks where
+    they are a few hundred bytes at a time with vector compares (SimdKernels.h).
 
 ==================================================================================================
 */
@@ -18,18 +22,26 @@ Description:
 #ifndef CSVFILEREADER_H
 #define CSVFILEREADER_H
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
-#include <fstream>
-#include <sstream>
+#include <string_view>
+
+#include "MappedFile.h"
+#include "SimdKernels.h"
 
 /**
- * @brief A wrapper class for a filestream plus a stringstream. Takes a filepath as constructor argument
+ * @brief A wrapper class for a mapped file. Takes a filepath as constructor argument
  *          and returns comma separated tokens by line with each call for nextToken.
- * 
+ *
  * This was supposed to make working with the csv data from main easier but it is at best a wash.
  * Still I must have learned something from writing it.
- * 
- * while (hasLines()) 
+ *
+ * Lines can end in \n or \r\n, and the last line doesn't need a newline at all.
+ * Tokens are only valid while the file is open (until CloseFile or the reader goes away), copy
+ * them into a std::string to keep them longer.
+ *
+ * while (hasLines())
  *      nextLine()
  *      while(hasTokens)
  *          nextToken
@@ -39,31 +51,48 @@ class CSVFileReader {
     private:
 
         std::string filePath;
-        std::ifstream inFS;
-        std::stringstream currentLine;
+        MappedFile file;
+
+        const char* textStart;  // first char of the text being parsed
+        const char* nextLine;   // start of the line after the current one, once lineScanned
+        const char* fileEnd;    // one past the last char in the file
+        const char* nextToken;  // start of the next token in the current line
+
+        // the current line's end is only found when its last token is, until then nextLine isn't known
+        bool lineScanned;
+
+        // where the commas and newlines are in the (up to MASK_BYTES) bytes from maskStart, one bit each (see nextDelimiter)
+        const char* maskStart;
+        std::size_t maskLength;
+        std::uint64_t masks[SimdKernels::MASK_BYTES / 64];
 
-        char nextChar;
-        bool linesAvail;
         bool tokensAvail;
         int currLineNumber;
 
-        void openFileStream();
-
     public:
 
         CSVFileReader();
         CSVFileReader(std::string filePath);
+        explicit CSVFileReader(std::string_view text); // parse text already in memory, e.g. a piece of another file
 
         std::string getFilePath() { return filePath; }
         std::string CurrentLineNumber() { return std::to_string(currLineNumber); }
-        bool hasLines() { return linesAvail; }
+        int LineNumber() const { return currLineNumber; }
+        std::string_view Contents() const { return std::string_view(textStart, fileEnd - textStart); } // everything
+        bool hasLines();
         bool hasTokens() { return tokensAvail; }
 
         void NextLine();
-        std::string NextToken();
+        std::string_view NextToken();
 
         void Reset();
-        void CloseFile() { inFS.close(); }
+        void CloseFile();
+
+    private:
+
+        void skipRestOfLine();
+        const char* nextDelimiter(const char* from);
+        const char* nextDelimiterSlow(const char* from);
 };
 
 #endif
\ No newline at end of file
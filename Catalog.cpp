@@ -0,0 +1,505 @@
+#include "Catalog.h"
+
+#include <algorithm> // std::max, std::min
+#include <atomic>
+#include <future> // results from the parsing threads
+#include <iterator> // std::make_move_iterator
+#include <stdexcept>
+#include <string_view>
+#include <thread> // feeds the parsing threads
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "BoundedQueue.h"
+#include "CatalogSnapshot.h"
+#include "CSVFileReader.h"
+#include "ThreadPool.h"
+
+// one piece of the input file after parsing, see validate
+struct ParsedChunk {
+    std::vector<Course> courses;
+    StringArena text; // the courses' names and prerequisites
+    std::vector<int> lines; // line (counted from the start of this piece) of each course
+    int lineCount = 0;   // lines in this piece
+    int errorLine = 0;   // line (counted from the start of this piece) of the first error, 0 if none
+    std::string error;
+};
+
+// loading steps, in the order they run
+void validate(CSVFileReader& csv, CourseIndex& into, CourseGraph& graph, StringArena& intoText);
+std::vector<std::string_view> splitAtLines(std::string_view text, std::size_t pieces);
+ParsedChunk parseChunk(std::string_view text);
+std::string parseCourse(CSVFileReader& csv, std::string_view ID, Course& course, StringArena& text, std::vector<std::string_view>& prereqs);
+std::string setID(Course& course, std::string_view ID);
+void indexChunk(ParsedChunk& chunk, int linesBefore, std::vector<Course>& into, CourseGraph& graph, StringArena& intoText);
+void checkPrereqs(CourseGraph& graph);
+void checkChanges(const Catalog& catalog, const CatalogChanges& changes);
+std::string lineError(int line, const std::string& problem, const std::string& file = "input file");
+
+// threads for parsing big files in pieces, one per core
+ThreadPool parsers;
+
+// a version number no catalog has had yet
+static std::uint64_t newVersion() {
+    static std::atomic<std::uint64_t> made{ 0 };
+    return ++made;
+}
+
+Catalog::Catalog() {
+    version = newVersion();
+}
+
+/**
+ * @brief Parse by comma, validate, and build a new catalog from a file. A snapshot file (see
+ * CatalogSnapshot.h) skips straight to building since it was validated when it was saved.
+ *
+ * @return the catalog, never partly built: any problem with the file throws runtime_error instead
+ */
+std::unique_ptr<Catalog> Catalog::Load(const std::string& filePath) {
+
+    std::unique_ptr<Catalog> loaded(new Catalog());
+
+    if (CatalogSnapshot::IsSnapshot(filePath)) {
+        CatalogSnapshot snapshot(filePath); // throws runtime errors
+        snapshot.LoadInto(loaded->courses, loaded->graph, loaded->text);
+    }
+    else {
+        auto csv = CSVFileReader(filePath); // throws runtime errors
+        validate(csv, loaded->courses, loaded->graph, loaded->text); // throws also runtime errors
+        csv.CloseFile();
+    }
+    CourseSchedule schedule(loaded->graph); // throws runtime errors if the prereqs have a cycle
+    loaded->schedule.Swap(schedule);
+
+#if defined(COURSEPLANNER_FLAT_INDEX)
+    loaded->courses.Rebuild(); // it would otherwise sort itself inside the first search, readers can't have that
+#elif defined(COURSEPLANNER_HASH_INDEX)
+    loaded->courses.EnableHashIndex(); // built once everything is in, searches use it from now on
+#endif
+    return loaded;
+}
+
+/**
+ * @brief Copy the whole catalog. The copy gets its own text, so either can be changed or freed without
+ * the other. The tree is rebuilt from the courses in order, O(n) without any comparisons.
+ */
+std::unique_ptr<Catalog> Catalog::Clone() const {
+
+    std::unique_ptr<Catalog> copy(new Catalog());
+
+    std::vector<Course> ordered;
+    std::vector<std::string_view> prereqs;
+    for (const auto& course : courses) {
+        Course copied(course.ID());
+        copied.SetName(copy->text.Copy(course.Name()));
+        prereqs.assign(course.GetPrereqs().begin(), course.GetPrereqs().end());
+        copied.SetPrereqs(copy->text.CopyAll(prereqs), prereqs.size());
+        ordered.push_back(std::move(copied));
+    }
+    copy->courses.BuildFrom(ordered.begin(), ordered.end(), true);
+    copy->graph = graph;
+    copy->schedule = schedule;
+
+#if defined(COURSEPLANNER_FLAT_INDEX)
+    copy->courses.Rebuild();
+#elif defined(COURSEPLANNER_HASH_INDEX)
+    if (courses.hasHashIndex()) copy->courses.EnableHashIndex();
+#endif
+    return copy;
+}
+
+/**
+ * @brief Add, replace and delete courses the way a change file says, instead of loading everything
+ * again. Everything is checked first (see checkChanges), so a change file that doesn't fit throws before
+ * anything has changed. Then the changed courses are taken out of the tree together and put back in with
+ * their new names and prerequisites, the graph gets its new edges and the schedule works out the semesters
+ * that could have moved. The text of replaced and deleted courses stays in the arena until the next Load.
+ *
+ * IDs match ignoring case like everywhere else, a replaced course keeps its ID as the catalog spells it.
+ */
+void Catalog::Apply(const CatalogChanges& changes) {
+
+    checkChanges(*this, changes); // throws runtime errors
+
+    std::vector<CourseGraph::Handle> changed;
+    std::vector<std::string_view> prereqs;
+    std::vector<std::string_view> replaced; // or deleted, either way the old course comes out of the tree
+    std::vector<Course> added;              // and the new ones go in, both as one batch after the loop
+
+    for (const auto& change : changes.changes) {
+        std::string_view ID = change.course.ID();
+        CourseGraph::Handle handle = graph.Find(ID);
+
+        if (graph.IsCourse(handle)) replaced.push_back(ID);
+
+        if (change.remove) {
+            graph.RemoveCourse(handle);
+        }
+        else {
+            if (! graph.IsCourse(handle)) handle = graph.AddCourse(ID, change.line);
+
+            Course course(graph.ID(handle)); // its text is the change file's, copy it into ours
+            course.SetName(text.Copy(change.course.Name()));
+            prereqs.assign(change.course.GetPrereqs().begin(), change.course.GetPrereqs().end());
+            course.SetPrereqs(text.CopyAll(prereqs), prereqs.size());
+            added.push_back(std::move(course));
+        }
+        changed.push_back(handle);
+    }
+
+    // no ID is changed twice (checkChanges), so taking every old course out before putting any new one in
+    // ends the same as one change at a time. a flat index closes up once and merges the new ones in once
+    courses.RemoveEach(replaced.begin(), replaced.end());
+    for (auto& course : added) courses.Insert(std::move(course));
+
+    // every course in the file has a handle by now, so prereqs can name courses added further down it
+    std::vector<CourseGraph::Handle> handles;
+    for (const auto& change : changes.changes) {
+        if (change.remove) continue;
+        handles.clear();
+        for (auto prereq : change.course.GetPrereqs()) handles.push_back(graph.Find(prereq));
+        graph.SetPrereqs(graph.Find(change.course.ID()), handles);
+    }
+
+    schedule.Update(graph, changed);
+
+#if defined(COURSEPLANNER_FLAT_INDEX)
+    courses.Rebuild(); // sorts the added courses and merges them in, O(n + klogk)
+#endif
+    version = newVersion(); // anything cached from this catalog is out of date
+}
+
+// read a change file (see CatalogChanges). same rules for a course line as loading has, checked line by line
+CatalogChanges CatalogChanges::Read(const std::string& filePath) {
+
+    CatalogChanges read;
+    auto csv = CSVFileReader(filePath); // throws runtime errors
+    std::vector<std::string_view> prereqs;
+
+    while (csv.hasLines()) {
+        csv.NextLine();
+        if (!csv.hasTokens()) continue; //skip empty line
+
+        Change change;
+        change.line = csv.LineNumber();
+        std::string_view ID = csv.NextToken();
+        change.remove = (! ID.empty() and ID.front() == '-');
+
+        std::string error;
+        if (change.remove) {
+            error = setID(change.course, ID.substr(1));
+            if (error.empty() and csv.hasTokens()) error = "A deleted course takes nothing but its ID.";
+        }
+        else {
+            error = parseCourse(csv, ID, change.course, read.text, prereqs);
+        }
+        if (error.empty() and (change.course.ID().empty() or (! change.remove and change.course.Name().empty()))) error = "Empty value.";
+        if (! error.empty()) throw std::runtime_error(lineError(change.line, error, "change file"));
+
+        read.changes.push_back(std::move(change));
+    }
+    csv.CloseFile();
+    return read;
+}
+
+// build course objects from file into the tree and graph while ensuring that parameters are met in file:
+// 1. at least two values exist on each line (comma seperated)
+// 2. any prerequisites exists as a course (first token of each line) somewhere in the file
+// 3. No empty values
+// 4. No course is listed twice
+// (prerequisites that loop are caught after this, when the schedule is worked out)
+void validate(CSVFileReader& csv, CourseIndex& into, CourseGraph& graph, StringArena& intoText) {
+
+    /* Loading is a pipeline instead of separate passes over the whole file:
+
+        file pieces -> parser threads -> queue (a few pieces at most) -> this thread: check + collect
+
+    The file is cut into pieces at line breaks and a feeder thread hands them to the parser threads. Parsed
+    pieces are picked up here in file order while the next ones are still being parsed, every course is checked
+    and moved onto one list, and its piece is thrown away. So at most a few pieces are ever held besides the
+    courses themselves. Each piece only knows its own line numbers, an error's real line is the lines in all the
+    pieces before it plus its line within the piece. Once every course is in, the tree is built from the list in
+    one go (BuildFrom: one sort, then linear) instead of n inserts one after another on this thread.
+
+    Every ID is interned into the graph as it comes by, prerequisites included, so a prerequisite further down
+    the file simply gets its handle early. Once everything is in, any handle that never turned into a course
+    is a missing prerequisite.
+    */
+    const std::size_t MIN_CHUNK_SIZE = 1 << 20; // not worth a thread for less than ~1MB
+    std::string_view text = csv.Contents();
+    std::size_t pieces = text.size() / MIN_CHUNK_SIZE + 1;
+    std::vector<std::string_view> chunks = splitAtLines(text, pieces);
+
+    // parsed pieces waiting to be indexed, in file order
+    BoundedQueue<std::future<ParsedChunk>> parsed(parsers.size() * 2);
+
+    std::thread feeder([&parsed, &chunks] {
+        for (auto chunk : chunks) {
+            auto result = parsers.Submit([chunk] { return parseChunk(chunk); });
+            if (! parsed.Push(std::move(result))) { // stopped early because of an error
+                result.wait(); // it points into the file, let it finish before the file can close
+                break;
+            }
+        }
+        parsed.Close(); // no more pieces coming
+    });
+
+    int linesBefore = 0;
+    std::string error;
+    std::vector<Course> courses; // checked, in file order
+
+    std::future<ParsedChunk> next;
+    while (parsed.Pop(next)) {
+        try {
+            ParsedChunk chunk = next.get();
+            if (error.empty()) indexChunk(chunk, linesBefore, courses, graph, intoText);
+            linesBefore += chunk.lineCount;
+        }
+        catch (std::exception& e) {
+            // remember the first error, stop the feeder and let the pieces already queued finish
+            if (error.empty()) error = e.what();
+            parsed.Close();
+        }
+    }
+    feeder.join();
+
+    if (! error.empty()) throw std::runtime_error(error);
+    checkPrereqs(graph); // throws error if invalid
+
+    // n log n for the sort (skipped for a file already in ID order), then linear
+    into.BuildFrom(std::make_move_iterator(courses.begin()), std::make_move_iterator(courses.end()), false);
+
+    //if no errors program reaches the end with every course validated and in the tree
+    // i suppose there can still be nonsense data ("ID: asdasdia") in the objects but is there a good way to validate that?
+}
+
+// check the courses of one parsed piece and move them onto 'into' and into the graph (see validate). their
+// text moves into 'intoText' as is, nothing is copied
+void indexChunk(ParsedChunk& chunk, int linesBefore, std::vector<Course>& into, CourseGraph& graph, StringArena& intoText) {
+
+    if (chunk.errorLine != 0) throw std::runtime_error(lineError(linesBefore + chunk.errorLine, chunk.error));
+    intoText.Adopt(chunk.text);
+
+    for (std::size_t i = 0; i < chunk.courses.size(); i++) {
+        Course& course = chunk.courses[i];
+        int line = linesBefore + chunk.lines[i];
+
+        if (course.ID().empty() or course.Name().empty()) throw std::runtime_error(lineError(line, "Empty value."));
+
+        CourseGraph::Handle handle = graph.AddCourse(course.ID(), line);
+        if (handle == CourseGraph::NONE) throw std::runtime_error(lineError(line, "Course " + std::string(course.ID()) + " is listed more than once."));
+
+        // prereqs of courses further down the file can't be checked yet, see checkPrereqs
+        for (auto prereq : course.GetPrereqs()) graph.AddPrereq(handle, prereq, line);
+
+        into.push_back(std::move(course));
+    }
+}
+
+// cut text into about 'pieces' equal parts, each ending right after a newline (except maybe the last)
+std::vector<std::string_view> splitAtLines(std::string_view text, std::size_t pieces) {
+
+    std::vector<std::string_view> chunks;
+    std::size_t start = 0;
+
+    for (std::size_t i = 1; i <= pieces and start < text.size(); i++) {
+
+        std::size_t end = text.size();
+        if (i < pieces) {
+            // move the cut forward to the next line break, unless the last cut already passed it
+            end = text.find('\n', std::max(start, text.size() / pieces * i));
+            end = (end == std::string_view::npos) ? text.size() : end + 1;
+        }
+        chunks.push_back(text.substr(start, end - start));
+        start = end;
+    }
+    return chunks;
+}
+
+// parse the course lines in one piece of the file (runs on a parser thread). stops at the first bad line
+ParsedChunk parseChunk(std::string_view text) {
+
+    ParsedChunk chunk;
+    CSVFileReader csv(text);
+    std::vector<std::string_view> prereqs; // one line's worth, reused
+
+    while (csv.hasLines()) { // iterate each line of file
+        csv.NextLine();
+        if (!csv.hasTokens()) continue; //skip empty line
+
+        Course newCourse;
+        std::string error = parseCourse(csv, csv.NextToken(), newCourse, chunk.text, prereqs);
+        if (! error.empty()) {
+            chunk.errorLine = csv.LineNumber();
+            chunk.error = error;
+            return chunk;
+        }
+
+        // then add the course to the list
+        chunk.courses.push_back(std::move(newCourse));
+        chunk.lines.push_back(csv.LineNumber());
+    }
+    chunk.lineCount = csv.LineNumber();
+    return chunk;
+}
+
+/**
+ * @brief One course line after its ID token: the name, then any prerequisites. Tokens point into the
+ * file, so what the course keeps is copied into text.
+ *
+ * @return what's wrong with the line, empty if nothing
+ */
+std::string parseCourse(CSVFileReader& csv, std::string_view ID, Course& course, StringArena& text, std::vector<std::string_view>& prereqs) {
+
+    // first token. it's kept inline in the course
+    std::string error = setID(course, ID);
+    if (! error.empty()) return error;
+
+    // second token does not exist?
+    if (!csv.hasTokens()) return "Not enough values in line.";
+
+    // second token
+    course.SetName(text.Copy(csv.NextToken()));
+
+    // -> n remaining tokens to prereqs
+    prereqs.clear();
+    while (csv.hasTokens()) prereqs.push_back(csv.NextToken());
+    course.SetPrereqs(text.CopyAll(prereqs), prereqs.size());
+    return "";
+}
+
+// IDs longer than a course can hold are an error in the file, not an exception from SetID
+std::string setID(Course& course, std::string_view ID) {
+    if (ID.size() > Course::MAX_ID_LENGTH) return "Course ID " + std::string(ID) + " is longer than " + std::to_string(Course::MAX_ID_LENGTH) + " characters.";
+    course.SetID(ID);
+    return "";
+}
+
+// every course is in the graph now. any prerequisite that still isn't a course is an error
+void checkPrereqs(CourseGraph& graph) {
+
+    // the graph tracks the first line naming each ID, so this is one pass over integers, no string lookups
+    int line = graph.FirstMissingPrereqLine();
+    if (line != 0) throw std::runtime_error(lineError(line, "One or more prerequisites do not exist as a course."));
+
+    graph.Finalize(); // pack the prerequisites for queries
+}
+
+/**
+ * @brief Would the catalog still be valid with these changes made? Checked against the catalog as it
+ * will be, only looking at the changed courses and the ones right next to them in the graph:
+ * 1. no course is changed twice, and a deleted course exists
+ * 2. no course left behind still lists a deleted course as a prerequisite
+ * 3. every prerequisite of an added or replaced course is a course after the changes
+ * 4. the prerequisites don't loop
+ *
+ * Throws runtime_error naming the change file line of the first problem.
+ */
+void checkChanges(const Catalog& catalog, const CatalogChanges& changes) {
+
+    using Change = CatalogChanges::Change;
+    const CourseGraph& graph = catalog.graph;
+
+    std::unordered_map<std::string_view, const Change*, Course::Hash, Course::SameID> changed; // by ID, in any case
+    for (const auto& change : changes.changes) {
+        std::string ID(change.course.ID());
+        if (! changed.emplace(change.course.ID(), &change).second) throw std::runtime_error(lineError(change.line, "Course " + ID + " is changed more than once.", "change file"));
+        if (change.remove and ! graph.IsCourse(graph.Find(ID))) throw std::runtime_error(lineError(change.line, "Course " + ID + " is not in the catalog.", "change file"));
+    }
+
+    auto isCourseAfter = [&](std::string_view ID) {
+        auto found = changed.find(ID);
+        return (found != changed.end()) ? ! found->second->remove : graph.IsCourse(graph.Find(ID));
+    };
+
+    for (const auto& change : changes.changes) {
+        if (change.remove) {
+            // whatever lists it has to be deleted or replaced too (3. then checks the replacement)
+            for (auto dependent : graph.Unlocks(graph.Find(change.course.ID()))) {
+                if (changed.count(graph.ID(dependent)) == 0) {
+                    throw std::runtime_error(lineError(change.line, "Course " + std::string(change.course.ID()) + " is still a prerequisite of " +
+                                                                    std::string(graph.ID(dependent)) + ".", "change file"));
+                }
+            }
+        }
+        else {
+            for (auto prereq : change.course.GetPrereqs()) {
+                if (! isCourseAfter(prereq)) throw std::runtime_error(lineError(change.line, "Prerequisite " + std::string(prereq) + " does not exist as a course.", "change file"));
+            }
+        }
+    }
+
+    /* The catalog had no loops, so a new one has to go through a changed course. Depth first from each
+    changed course (explicit stack, like the schedule) down the prerequisites as they will be: a changed
+    course's from the change file, anything else's from the graph. done[ID] is false while ID is on the stack.
+
+    An unchanged course only leads down to earlier semesters, and a changed course it can lead to has to be
+    one that was in the catalog before. So nothing unchanged in or before the earliest semester among those
+    can lead back to a changed course, and the search doesn't go below there. That keeps it to the courses
+    between the changes, not everything they require.
+    */
+    std::uint32_t earliest = 0xFFFFFFFF;
+    for (const auto& change : changes.changes) {
+        CourseGraph::Handle handle = graph.Find(change.course.ID());
+        if (! change.remove and graph.IsCourse(handle)) earliest = std::min<std::uint32_t>(earliest, catalog.schedule.Semester(handle));
+    }
+
+    struct Visit {
+        std::string_view ID;
+        const Course* changedTo; // nullptr for a course that isn't changed
+        CourseGraph::Handles graphPrereqs;
+        std::size_t next;
+
+        std::size_t size() const { return changedTo ? changedTo->GetPrereqs().size() : graphPrereqs.size(); }
+    };
+    auto visit = [&](std::string_view ID) {
+        auto found = changed.find(ID);
+        if (found != changed.end()) return Visit{ ID, &found->second->course, { nullptr, nullptr }, 0 };
+        return Visit{ ID, nullptr, graph.Prereqs(graph.Find(ID)), 0 };
+    };
+
+    std::unordered_map<std::string_view, bool, Course::Hash, Course::SameID> done;
+    std::vector<Visit> stack;
+
+    for (const auto& change : changes.changes) {
+        if (change.remove or done.count(change.course.ID()) != 0) continue;
+        stack.push_back(visit(change.course.ID()));
+        done[change.course.ID()] = false;
+
+        while (! stack.empty()) {
+            Visit& top = stack.back();
+            if (top.next == top.size()) {
+                done[top.ID] = true;
+                stack.pop_back();
+                continue;
+            }
+
+            std::string_view prereq = top.changedTo ? top.changedTo->GetPrereqs().first[top.next] : graph.ID(top.graphPrereqs.first[top.next]);
+            top.next++;
+
+            auto found = done.find(prereq);
+            if (found == done.end() and changed.count(prereq) == 0 and
+                static_cast<std::uint32_t>(catalog.schedule.Semester(graph.Find(prereq))) <= earliest) {
+                continue; // can't lead back
+            }
+            if (found == done.end()) {
+                done[prereq] = false;
+                stack.push_back(visit(prereq)); // top is gone after this
+            }
+            else if (! found->second) { // case: cycle
+                std::string cycle;
+                std::size_t from = stack.size() - 1;
+                while (! Course::SameID()(stack[from].ID, prereq)) from--;
+                for (std::size_t i = from; i < stack.size(); i++) cycle += std::string(stack[i].ID) + " -> ";
+                cycle += std::string(prereq);
+                throw std::runtime_error(lineError(change.line, "Prerequisites would form a cycle (" + cycle + ", each course requires the next).", "change file"));
+            }
+        }
+    }
+}
+
+// "Error in input file (line n): problem"
+std::string lineError(int line, const std::string& problem, const std::string& file) {
+    return "Error in " + file + " (line " + std::to_string(line) + "): " + problem;
+}
\ No newline at end of file
@@ -0,0 +1,109 @@
+/*
+==================================================================================================
+Name        :   Catalog.h
+Author      :   Craig O'Loughlin
+Version     :   1
+Date        :   10/16/2026
+
+Description:
+
+    Everything loaded from one course file, kept together: the courses, the text they point at,
+    the prerequisite graph and the schedule worked out from it. A catalog is built in one go by
+    Load and only read after that, so any number of threads can read one at the same time.
+    Loading another file builds a whole new catalog next to the old one (see EpochPointer.h for
+    how the program swaps them). Course IDs in a file can be at most 15 characters (Course.h).
+
+    A change file (CatalogChanges) adds, replaces and deletes a few courses without loading
+    everything again. Apply changes a catalog in place, so it is only ever used on a catalog no
+    reader can see (CoursePlanner.cpp keeps two copies and takes turns).
+
+==================================================================================================
+*/
+
+#ifndef CATALOG_H
+#define CATALOG_H
+
+#include <cstdint>
+#include <functional> // std::less<>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Course.h"
+#include "BinarySearchTree.h"
+#include "FlatSearchIndex.h"
+#include "CourseGraph.h"
+#include "CourseSchedule.h"
+#include "StringArena.h"
+
+// which container holds the courses. both have the same interface, so this is the only line that decides.
+// the tree is the default, compile with COURSEPLANNER_FLAT_INDEX defined for the sorted array index, which
+// searches faster on big catalogs but is slow to change one course at a time, or COURSEPLANNER_HASH_INDEX
+// for the tree plus a hash index on the IDs (O(1) lookups for more memory)
+#if defined(COURSEPLANNER_FLAT_INDEX)
+using CourseIndex = FlatSearchIndex<Course>;
+#elif defined(COURSEPLANNER_HASH_INDEX)
+using CourseIndex = BinarySearchTree<Course, std::less<>, NodeArena, Course::Hash>;
+#else
+using CourseIndex = BinarySearchTree<Course>;
+#endif
+
+/**
+ * @brief A change file, parsed and holding its own text, ready to Apply to any number of catalogs.
+ *
+ * One change per line, in the course file's format. A course line adds that course, or replaces the
+ * course with the same ID (name and prerequisites). A line with just the ID after a '-' deletes it:
+ *      CSCI400,Big Data,CSCI300
+ *      -CSCI100
+ */
+class CatalogChanges {
+
+    public:
+
+        struct Change {
+            Course course; // only the ID for a delete
+            bool remove = false;
+            int line = 0;
+        };
+
+        std::vector<Change> changes; // in file order
+        StringArena text;
+
+        static CatalogChanges Read(const std::string& filePath); // throws runtime_error for a badly formed line
+};
+
+/**
+ * @brief A loaded, validated course catalog. Read only once Load returns it, share it as const.
+ *
+ * std::unique_ptr<Catalog> catalog = Catalog::Load("courses.csv");   // csv or snapshot
+ * const Course* course = catalog->courses.Find("CSCI300");
+ * catalog->schedule.Semester(catalog->graph.Find(course->ID()));
+ */
+class Catalog {
+
+    public:
+
+        CourseIndex courses;
+        CourseGraph graph;
+        CourseSchedule schedule;
+        StringArena text; // the courses' names and prerequisites, the courses only point into it
+
+        Catalog(); // empty
+        Catalog(const Catalog&) = delete;
+        Catalog& operator=(const Catalog&) = delete;
+
+        static std::unique_ptr<Catalog> Load(const std::string& filePath); // throws runtime_error saying what's wrong with the file
+        std::unique_ptr<Catalog> Clone() const; // a copy with text of its own, O(catalog)
+
+        // O(changes + the courses building on them). throws runtime_error and changes nothing if the changes don't fit
+        void Apply(const CatalogChanges& changes);
+
+        bool isEmpty() const { return courses.isEmpty(); }
+        std::uint64_t Version() const { return version; } // different for every catalog made, for caches built from one
+
+    private:
+
+        std::uint64_t version;
+};
+
+#endif
\ No newline at end of file
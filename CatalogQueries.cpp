@@ -0,0 +1,269 @@
+#include "CatalogQueries.h"
+
+#include <algorithm> // std::sort
+#include <cstdint>
+#include <cstring> // memcmp
+#include <stdexcept>
+#include <vector>
+
+#include "Course.h"
+
+// a command line split into its name and argument, spaces (and a CR from a Windows file) trimmed off both
+struct Command {
+    std::string_view name;
+    std::string_view argument;
+};
+
+static std::string_view trim(std::string_view text) {
+    while (! text.empty() and (text.front() == ' ' or text.front() == '\t')) text.remove_prefix(1);
+    while (! text.empty() and (text.back() == ' ' or text.back() == '\t' or text.back() == '\r')) text.remove_suffix(1);
+    return text;
+}
+
+static Command parse(std::string_view line) {
+    line = trim(line);
+    std::size_t space = line.find(' ');
+    if (space == std::string_view::npos) return { line, std::string_view() };
+    return { line.substr(0, space), trim(line.substr(space + 1)) };
+}
+
+// a found course, or the line saying it wasn't found
+static void appendFound(const Course* course, std::string_view ID, std::string& out) {
+    if (course != nullptr) {
+        course->AppendTo(out);
+        course->AppendPrereqsTo(out);
+    } else {
+        out += ID;
+        out += " not found.\n";
+    }
+}
+
+// answer one command, see the header for the list
+bool CatalogQueries::Run(const Catalog& catalog, PrereqClosure& closures, std::string_view line, std::string& out) {
+
+    Command command = parse(line);
+
+    if (command.name.empty()) return true;
+    if (command.name == "find") Find(catalog, command.argument, out);
+    else if (command.name == "list") List(catalog, out);
+    else if (command.name == "prefix") Prefix(catalog, command.argument, out);
+    else if (command.name == "prereqs") Prereqs(catalog, closures, command.argument, out);
+    else if (command.name == "schedule") Schedule(catalog, closures, command.argument, out);
+    else if (command.name == "range" and command.argument.find('-') != std::string_view::npos) {
+        std::size_t dash = command.argument.find('-');
+        Range(catalog, command.argument.substr(0, dash), command.argument.substr(dash + 1), out);
+    }
+    else {
+        out += "Unknown command: ";
+        out += trim(line);
+        out += '\n';
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Answer every command in a stream, in order, and write the answers out in big pieces instead of
+ * a line at a time.
+ *
+ * The stream is read a block (about BATCH_BLOCK bytes of whole lines) at a time and each block is answered
+ * before the next is read, so memory stays the same however many commands there are. Answers collect in one
+ * string that is written once it passes OUTPUT_BUFFER.
+ *
+ * @param sortLookups look the finds in each block up in ID order instead of the order given. Neighbouring
+ *                    lookups then walk down mostly the same tree nodes, which are still in cache. The answers
+ *                    still come out in the order the commands were given.
+ */
+std::size_t CatalogQueries::RunBatch(const Catalog& catalog, std::istream& in, std::ostream& out, bool sortLookups) {
+
+    std::string pending; // read but not answered yet, always starts at the beginning of a line
+    std::string answers;
+    PrereqClosure closures(catalog.graph);
+    std::vector<char> chunk(BATCH_BLOCK);
+    std::size_t commands = 0;
+
+    while (true) {
+        in.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        std::size_t got = static_cast<std::size_t>(in.gcount());
+        pending.append(chunk.data(), got);
+        bool last = (got == 0);
+
+        // answer every whole line read so far. the last line of the stream doesn't need its newline
+        std::size_t end = last ? pending.size() : pending.rfind('\n');
+        if (end == std::string::npos) continue; // one very long line, keep reading
+        if (! last) end++;
+
+        commands += runBlock(catalog, closures, std::string_view(pending).substr(0, end), answers, sortLookups);
+        pending.erase(0, end);
+
+        if (answers.size() >= OUTPUT_BUFFER or last) {
+            out.write(answers.data(), static_cast<std::streamsize>(answers.size()));
+            answers.clear();
+        }
+        if (last) break;
+    }
+    out.flush();
+    return commands;
+}
+
+/* Answer a block of command lines. Finds are looked up first, all together (sorted by key if asked), and
+their results kept by line. Then every line's answer goes out in order, the finds from what was kept.
+*/
+std::size_t CatalogQueries::runBlock(const Catalog& catalog, PrereqClosure& closures, std::string_view lines, std::string& out, bool sortLookups) {
+
+    std::vector<std::string_view> block;
+    std::vector<Command> parsed;
+    for (std::size_t start = 0; start < lines.size(); ) {
+        std::size_t end = lines.find('\n', start);
+        if (end == std::string_view::npos) end = lines.size();
+        block.push_back(lines.substr(start, end - start));
+        parsed.push_back(parse(block.back()));
+        start = end + 1;
+    }
+
+    // (key, line) for every find. the key is folded once here instead of at every node the search passes,
+    // and orders IDs the same way the tree does (see Course::IDKey)
+    struct Lookup {
+        Course::IDKey ID;
+        std::uint32_t line;
+    };
+    std::vector<Lookup> lookups;
+    for (std::size_t line = 0; line < block.size(); line++) {
+        if (parsed[line].name == "find") lookups.push_back({ Course::IDKey(parsed[line].argument), static_cast<std::uint32_t>(line) });
+    }
+    if (sortLookups) {
+        std::sort(lookups.begin(), lookups.end(), [](const Lookup& lhs, const Lookup& rhs) {
+            return std::memcmp(lhs.ID.key, rhs.ID.key, Course::KEY_SIZE) < 0;
+        });
+    }
+
+    std::vector<const Course*> found(block.size(), nullptr);
+    for (const auto& lookup : lookups) found[lookup.line] = catalog.courses.Find(lookup.ID);
+
+    std::size_t commands = 0;
+    for (std::size_t line = 0; line < block.size(); line++) {
+        if (parsed[line].name.empty()) continue;
+        commands++;
+        if (parsed[line].name == "find") appendFound(found[line], parsed[line].argument, out);
+        else Run(catalog, closures, block[line], out);
+    }
+    return commands;
+}
+
+// the course and its prerequisites, same as printing it from the menu
+void CatalogQueries::Find(const Catalog& catalog, std::string_view ID, std::string& out) {
+    appendFound(catalog.courses.Find(ID), ID, out);
+}
+
+/* The semester of a course in the tree. Every course in the tree is a course in the graph with a semester,
+Load and Apply keep it that way. If they ever don't, stop right here instead of indexing with it.
+*/
+static int semesterOf(const Catalog& catalog, const Course& course) {
+    CourseGraph::Handle handle = catalog.graph.Find(course.ID());
+    int semester = catalog.graph.IsCourse(handle) ? catalog.schedule.Semester(handle) : 0;
+    if (semester < 1 or semester > catalog.schedule.SemesterCount()) {
+        throw std::logic_error("Error: course " + std::string(course.ID()) + " is in the tree but has no semester in the graph.");
+    }
+    return semester;
+}
+
+// every course, one semester at a time so prerequisites always come first
+void CatalogQueries::List(const Catalog& catalog, std::string& out) {
+
+    // the tree still gives alphabetical order, just sort its courses into their semesters on the way
+    std::vector<std::vector<const Course*>> semesters(catalog.schedule.SemesterCount());
+    for (const auto& course : catalog.courses) {
+        semesters[semesterOf(catalog, course) - 1].push_back(&course); // points into the tree
+    }
+
+    for (std::size_t semester = 0; semester < semesters.size(); semester++) {
+        out += "Semester " + std::to_string(semester + 1) + ":\n";
+        for (auto course : semesters[semester]) course->AppendTo(out);
+        out += '\n';
+    }
+}
+
+// every course starting with a prefix ("CSCI3"). the tree walks down once to the first match and streams from there
+void CatalogQueries::Prefix(const Catalog& catalog, std::string_view prefix, std::string& out) {
+
+    auto found = catalog.courses.Prefix(prefix);
+    if (found.empty()) {
+        out += "No courses match ";
+        out += prefix;
+        out += ".\n";
+    }
+    for (const auto& course : found) course.AppendTo(out);
+}
+
+// every course between two IDs, both included
+void CatalogQueries::Range(const Catalog& catalog, std::string_view first, std::string_view last, std::string& out) {
+
+    auto found = catalog.courses.Range(first, last);
+    if (found.empty()) {
+        out += "No courses match ";
+        out += first;
+        out += '-';
+        out += last;
+        out += ".\n";
+    }
+    for (const auto& course : found) course.AppendTo(out);
+}
+
+// everything required before a course ("CSCI300 requires: ..."), in the order it would be taken
+void CatalogQueries::Prereqs(const Catalog& catalog, PrereqClosure& closures, std::string_view ID, std::string& out) {
+
+    const Course* course = catalog.courses.Find(ID);
+    if (course == nullptr) {
+        appendFound(nullptr, ID, out);
+        return;
+    }
+
+    std::vector<CourseGraph::Handle> all = required(closures, catalog.graph.Find(course->ID()));
+    out += course->ID();
+    out += all.empty() ? " requires nothing.\n" : " requires: " + CourseList(catalog, all) + "\n";
+}
+
+/**
+ * @brief The fastest way to a course: everything it requires, one line per semester, ending with the
+ * course itself. Every semester before the course's has something in it (its longest prerequisite chain
+ * goes through each one), so the numbers are the real semesters.
+ */
+void CatalogQueries::Schedule(const Catalog& catalog, PrereqClosure& closures, std::string_view ID, std::string& out) {
+
+    const Course* course = catalog.courses.Find(ID);
+    if (course == nullptr) {
+        appendFound(nullptr, ID, out);
+        return;
+    }
+
+    CourseGraph::Handle handle = catalog.graph.Find(course->ID());
+    std::vector<std::vector<CourseGraph::Handle>> semesters(semesterOf(catalog, *course));
+    for (auto prereq : required(closures, handle)) semesters[catalog.schedule.Semester(prereq) - 1].push_back(prereq);
+    semesters.back().push_back(handle);
+
+    for (std::size_t semester = 0; semester < semesters.size(); semester++) {
+        out += "Semester " + std::to_string(semester + 1) + ": " + CourseList(catalog, semesters[semester]) + "\n";
+    }
+}
+
+std::string CatalogQueries::CourseList(const Catalog& catalog, std::vector<CourseGraph::Handle> handles) {
+
+    std::sort(handles.begin(), handles.end(), [&catalog](CourseGraph::Handle lhs, CourseGraph::Handle rhs) {
+        if (catalog.schedule.Semester(lhs) != catalog.schedule.Semester(rhs)) return catalog.schedule.Semester(lhs) < catalog.schedule.Semester(rhs);
+        return Course::IDLess()(catalog.graph.ID(lhs), catalog.graph.ID(rhs)); // the order list and the tree use
+    });
+
+    std::string list;
+    for (auto course : handles) {
+        if (! list.empty()) list += ", ";
+        list += catalog.graph.ID(course);
+    }
+    return list;
+}
+
+// the handles in a course's prerequisite closure (cached in closures after the first time)
+std::vector<CourseGraph::Handle> CatalogQueries::required(PrereqClosure& closures, CourseGraph::Handle course) {
+    std::vector<CourseGraph::Handle> all;
+    closures.Closure(course).ForEach([&all](std::size_t prereq) { all.push_back(static_cast<CourseGraph::Handle>(prereq)); });
+    return all;
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+/*
+==================================================================================================
+Name        :   CatalogQueries.h
+Author      :   Craig O'Loughlin
+Version     :   1
+Date        :   10/16/2026
+
+Description:
+
+    Questions about a loaded catalog asked as lines of text instead of through the menu, for
+    scripts, report jobs and the query server. Answers are added to a string instead of printed,
+    so any number of them go out in one write. The console menu uses the same functions for the
+    matching options, so the answers look the same either way.
+
+==================================================================================================
+*/
+
+#ifndef CATALOGQUERIES_H
+#define CATALOGQUERIES_H
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Catalog.h"
+#include "CourseGraph.h"
+#include "PrereqClosure.h"
+
+/**
+ * @brief Command lines answered against a catalog. One command per line:
+ *
+ *      find CSCI300            the course and its prerequisites ("CSCI300 not found." if it isn't there)
+ *      list                    every course, semester by semester
+ *      prefix CSCI3            the courses whose IDs start with CSCI3
+ *      range MATH100-MATH299   the courses from MATH100 to MATH299, both included
+ *      prereqs CSCI300         everything required before CSCI300, directly or not
+ *      schedule CSCI300        the semesters it takes to get to CSCI300, and what to take in each
+ *
+ * IDs are matched ignoring case, the same as searching from the menu. Blank lines are skipped.
+ *
+ * PrereqClosure closures(catalog.graph);    // caches the prereqs/schedule answers, one per thread
+ * std::string out;
+ * CatalogQueries::Run(catalog, closures, "find CSCI300", out);
+ * CatalogQueries::RunBatch(catalog, std::cin, std::cout, true);   // a whole stream of them
+ */
+class CatalogQueries {
+
+    public:
+
+        static constexpr std::size_t OUTPUT_BUFFER = std::size_t(4) << 20; // batch answers are written out about this many bytes at a time
+        static constexpr std::size_t BATCH_BLOCK = std::size_t(1) << 20;   // and commands read in about this many
+
+        // false (and a line saying so) for an unknown command. closures has to be Reset to catalog.graph
+        static bool Run(const Catalog& catalog, PrereqClosure& closures, std::string_view command, std::string& out);
+        static std::size_t RunBatch(const Catalog& catalog, std::istream& in, std::ostream& out, bool sortLookups); // returns how many commands ran
+
+        static void Find(const Catalog& catalog, std::string_view ID, std::string& out);
+        static void List(const Catalog& catalog, std::string& out);
+        static void Prefix(const Catalog& catalog, std::string_view prefix, std::string& out);
+        static void Range(const Catalog& catalog, std::string_view first, std::string_view last, std::string& out);
+        static void Prereqs(const Catalog& catalog, PrereqClosure& closures, std::string_view ID, std::string& out);
+        static void Schedule(const Catalog& catalog, PrereqClosure& closures, std::string_view ID, std::string& out);
+
+        // course IDs separated by commas, in the order the schedule would have them taken
+        static std::string CourseList(const Catalog& catalog, std::vector<CourseGraph::Handle> handles);
+
+    private:
+
+        static std::size_t runBlock(const Catalog& catalog, PrereqClosure& closures, std::string_view lines, std::string& out, bool sortLookups);
+        static std::vector<CourseGraph::Handle> required(PrereqClosure& closures, CourseGraph::Handle course);
+};
+
+#endif
\ No newline at end of file
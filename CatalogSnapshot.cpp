@@ -0,0 +1,199 @@
+#include "CatalogSnapshot.h"
+
+#include <algorithm> // std::lower_bound
+#include <cstring> // memcpy, memcmp
+#include <filesystem> // rename over the old snapshot
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @brief Write every course to a snapshot file. The file is written next to its final name first and
+ * renamed into place, so a crash halfway never leaves a broken snapshot behind.
+ *
+ * @param filePath where to save
+ * @param courses validated courses in ID order, every prerequisite has to be one of them
+ */
+void CatalogSnapshot::write(const std::string& filePath, const std::vector<const Course*>& courses) {
+
+    const std::uint64_t MAX_FIELD = std::numeric_limits<std::uint32_t>::max();
+
+    // courses are numbered in tree order, prerequisites are saved as these numbers. a prerequisite's number
+    // is found by binary search, ignoring case like the tree (a prerequisite may be spelled differently)
+    std::uint64_t count = courses.size();
+    if (count > MAX_FIELD) throw std::runtime_error("Error: too many courses for a snapshot.");
+    auto numberOf = [&courses](std::string_view ID) -> std::uint64_t {
+        auto found = std::lower_bound(courses.begin(), courses.end(), ID, [](const Course* course, std::string_view key) { return *course < key; });
+        return (found != courses.end() and ! (ID < **found)) ? found - courses.begin() : MAX_FIELD;
+    };
+
+    std::vector<Record> records;
+    std::vector<std::uint32_t> prereqs;
+    std::string strings;
+    records.reserve(count);
+
+    for (auto course : courses) {
+
+        if (prereqs.size() + course->GetPrereqs().size() > MAX_FIELD) { // IDs and names are already held to 32 bits by Course
+            throw std::runtime_error("Error: course " + std::string(course->ID()) + " is too large for a snapshot.");
+        }
+
+        Record record = {};
+        record.idOffset = strings.size();
+        record.idLength = static_cast<std::uint32_t>(course->ID().size());
+        strings += course->ID();
+        record.nameOffset = strings.size();
+        record.nameLength = static_cast<std::uint32_t>(course->Name().size());
+        strings += course->Name();
+
+        record.firstPrereq = static_cast<std::uint32_t>(prereqs.size());
+        record.prereqCount = static_cast<std::uint32_t>(course->GetPrereqs().size());
+        for (auto prereq : course->GetPrereqs()) {
+            std::uint64_t number = numberOf(prereq);
+            if (number == MAX_FIELD) throw std::runtime_error("Error: prerequisite " + std::string(prereq) + " is not a course.");
+            prereqs.push_back(static_cast<std::uint32_t>(number));
+        }
+        records.push_back(record);
+    }
+
+    Header header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byteOrder = BYTE_ORDER_CHECK;
+    header.courseCount = records.size();
+    header.prereqCount = prereqs.size();
+    header.stringBytes = strings.size();
+    header.recordsOffset = sizeof(Header); // 64, keeps the records 8 byte aligned
+    header.prereqsOffset = header.recordsOffset + records.size() * sizeof(Record);
+    header.stringsOffset = header.prereqsOffset + prereqs.size() * sizeof(std::uint32_t);
+
+    std::string tempPath = filePath + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (! out.is_open()) throw std::runtime_error("Error opening file: " + tempPath);
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(Record));
+        out.write(reinterpret_cast<const char*>(prereqs.data()), prereqs.size() * sizeof(std::uint32_t));
+        out.write(strings.data(), strings.size());
+
+        out.close();
+        if (out.fail()) throw std::runtime_error("Error writing file: " + tempPath);
+    }
+
+    std::error_code renameError;
+    std::filesystem::rename(tempPath, filePath, renameError);
+    if (renameError) throw std::runtime_error("Error writing file: " + filePath + " (" + renameError.message() + ")");
+}
+
+// does the file start with the snapshot magic? false for anything else, including files that can't be read
+bool CatalogSnapshot::IsSnapshot(const std::string& filePath) {
+
+    char magic[sizeof(MAGIC)] = {};
+    std::ifstream in(filePath, std::ios::binary);
+    in.read(magic, sizeof(magic));
+    return in.gcount() == sizeof(magic) and std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+/**
+ * @brief Map a snapshot file and check its header and section bounds. That's O(1), the records
+ * themselves are only looked at when asked for.
+ */
+CatalogSnapshot::CatalogSnapshot(const std::string& filePath) : filePath(filePath), file(filePath) {
+
+    if (file.size() < sizeof(Header)) corrupt();
+    std::memcpy(&header, file.data(), sizeof(Header));
+
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) corrupt();
+    if (header.byteOrder != BYTE_ORDER_CHECK) {
+        throw std::runtime_error("Error: " + filePath + " was saved on a machine with a different byte order.");
+    }
+    if (header.version != VERSION) {
+        throw std::runtime_error("Error: " + filePath + " is snapshot version " + std::to_string(header.version) +
+                                 ", this program reads version " + std::to_string(VERSION) + ".");
+    }
+
+    // every section has to fit in the file (written so none of the math can overflow)
+    std::uint64_t fileSize = file.size();
+    auto fits = [fileSize](std::uint64_t offset, std::uint64_t count, std::uint64_t itemSize) {
+        return offset <= fileSize and count <= (fileSize - offset) / itemSize;
+    };
+    if (header.recordsOffset % alignof(Record) != 0 or header.prereqsOffset % alignof(std::uint32_t) != 0 or
+        ! fits(header.recordsOffset, header.courseCount, sizeof(Record)) or
+        ! fits(header.prereqsOffset, header.prereqCount, sizeof(std::uint32_t)) or
+        ! fits(header.stringsOffset, header.stringBytes, 1)) {
+        corrupt();
+    }
+
+    records = reinterpret_cast<const Record*>(file.data() + header.recordsOffset);
+    prereqs = reinterpret_cast<const std::uint32_t*>(file.data() + header.prereqsOffset);
+    strings = file.data() + header.stringsOffset;
+}
+
+std::string_view CatalogSnapshot::ID(std::size_t index) const {
+    return text(records[index].idOffset, records[index].idLength);
+}
+
+std::string_view CatalogSnapshot::Name(std::size_t index) const {
+    return text(records[index].nameOffset, records[index].nameLength);
+}
+
+/* Build the Course for one record. 'copied' is the strings section already copied into text (see LoadInto),
+the name and prerequisite IDs are views of that copy, the only new thing is the course's array of views.
+*/
+Course CatalogSnapshot::makeCourse(std::size_t index, const char* copied, StringArena& text) const {
+
+    const Record& record = records[index];
+    if (record.firstPrereq > header.prereqCount or record.prereqCount > header.prereqCount - record.firstPrereq) corrupt();
+    auto inCopy = [this, copied](std::string_view mapped) { return std::string_view(copied + (mapped.data() - strings), mapped.size()); };
+
+    if (ID(index).size() > Course::MAX_ID_LENGTH) corrupt(); // never written by this version
+    Course course(ID(index));
+    course.SetName(inCopy(Name(index)));
+
+    std::string_view* prereqIDs = text.Allocate<std::string_view>(record.prereqCount);
+    for (std::uint32_t i = 0; i < record.prereqCount; i++) {
+        std::uint32_t prereq = prereqs[record.firstPrereq + i];
+        if (prereq >= header.courseCount) corrupt();
+        prereqIDs[i] = inCopy(ID(prereq));
+    }
+    course.SetPrereqs(prereqIDs, record.prereqCount);
+    return course;
+}
+
+/**
+ * @brief Replace the graph with the courses in this snapshot. Graph handles are the record numbers,
+ * which is exactly how the prereqs are stored, so the prereq arrays go in as they are. Also checks
+ * every ID comes after the one before it in the tree's order, LoadInto builds the tree trusting that.
+ */
+void CatalogSnapshot::loadGraph(CourseGraph& graph) const {
+
+    graph.Clear();
+    char previous[Course::KEY_SIZE];
+    char key[Course::KEY_SIZE];
+    for (std::size_t index = 0; index < size(); index++) {
+        Course::MakeKey(ID(index), key); // the whole ID, they are never longer than a key
+        if (index > 0 and std::memcmp(previous, key, Course::KEY_SIZE) >= 0) corrupt(); // out of order or a duplicate
+        std::memcpy(previous, key, Course::KEY_SIZE);
+
+        if (graph.AddCourse(ID(index), 0) != index) corrupt(); // duplicate ID
+    }
+    for (std::size_t index = 0; index < size(); index++) {
+        const Record& record = records[index];
+        for (std::uint32_t i = 0; i < record.prereqCount; i++) {
+            graph.AddPrereq(static_cast<CourseGraph::Handle>(index), prereqs[record.firstPrereq + i]);
+        }
+    }
+    graph.Finalize();
+}
+
+// a string in the strings section
+std::string_view CatalogSnapshot::text(std::uint64_t offset, std::uint32_t length) const {
+    if (offset > header.stringBytes or length > header.stringBytes - offset) corrupt();
+    return std::string_view(strings + offset, length);
+}
+
+void CatalogSnapshot::corrupt() const {
+    throw std::runtime_error("Error: " + filePath + " is not a valid catalog snapshot.");
+}
\ No newline at end of file
@@ -0,0 +1,145 @@
+/*
+==================================================================================================
+Name        :   CatalogSnapshot.h
+Author      :   Craig O'Loughlin
+Version     :   1
+Date        :   10/16/2026
+
+Description:
+
+    Save a loaded and validated course catalog to a compact binary file and load it back without
+    parsing the text or sorting the courses again. Loading is still a linear rebuild, not a read
+    in place: the file is memory mapped, its strings are copied into the catalog's arena in one
+    go, every ID is interned into the prerequisite graph again, the tree is built from the
+    records as they come, and Catalog::Load works out the schedule again afterwards.
+
+    Layout (version 1, all numbers in the byte order of the machine that wrote it):
+
+        header      magic "CPSNAPSH", version, byte order check, counts and section offsets
+        records     one fixed 32 byte record per course, in ID order
+        prereqs     uint32 record number of every prerequisite, each course's run is contiguous
+        strings     every ID and name back to back (no separators, records hold offset + length)
+
+==================================================================================================
+*/
+
+#ifndef CATALOGSNAPSHOT_H
+#define CATALOGSNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Course.h"
+#include "MappedFile.h"
+#include "StringArena.h"
+#include "CourseGraph.h"
+
+/**
+ * @brief A snapshot file opened for reading. Records are in the same order the tree iterates, so
+ * loading into a tree is a single linear BuildFrom. That order is checked while loading the graph (one
+ * key compare per course) before the tree trusts it, a file with records out of order is corrupt.
+ * Write and LoadInto take either course container (BinarySearchTree or FlatSearchIndex), anything
+ * with ordered iteration and BuildFrom works.
+ *
+ * CatalogSnapshot::Write("catalog.snap", courses);
+ * CatalogSnapshot snapshot("catalog.snap");
+ * snapshot.LoadInto(courses, graph, text);   // text: the StringArena the courses will point into
+ */
+class CatalogSnapshot {
+
+    public:
+
+        static constexpr std::uint32_t VERSION = 1;
+
+        struct Header {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t byteOrder;        // BYTE_ORDER_CHECK as written, looks different if read on the other endianness
+            std::uint64_t courseCount;
+            std::uint64_t prereqCount;
+            std::uint64_t stringBytes;
+            std::uint64_t recordsOffset;    // from the start of the file
+            std::uint64_t prereqsOffset;
+            std::uint64_t stringsOffset;
+        };
+
+        struct Record {
+            std::uint64_t idOffset;         // into the strings section
+            std::uint64_t nameOffset;
+            std::uint32_t idLength;
+            std::uint32_t nameLength;
+            std::uint32_t firstPrereq;      // into the prereqs section
+            std::uint32_t prereqCount;
+        };
+
+        // walks the records as Course objects, for BuildFrom. the courses point into 'copied', the strings
+        // section after LoadInto copied it into an arena
+        class CourseIterator {
+            public:
+                using iterator_category = std::input_iterator_tag;
+                using value_type = Course;
+                using difference_type = std::ptrdiff_t;
+                using pointer = const Course*;
+                using reference = Course;
+
+                CourseIterator(const CatalogSnapshot* snapshot, std::size_t index, const char* copied, StringArena* text)
+                    : snapshot(snapshot), index(index), copied(copied), text(text) {}
+                Course operator*() const { return snapshot->makeCourse(index, copied, *text); }
+                CourseIterator& operator++() { index++; return *this; }
+                bool operator==(const CourseIterator& rhs) const { return index == rhs.index; }
+                bool operator!=(const CourseIterator& rhs) const { return index != rhs.index; }
+
+            private:
+                const CatalogSnapshot* snapshot;
+                std::size_t index;
+                const char* copied;
+                StringArena* text;
+        };
+
+        explicit CatalogSnapshot(const std::string& filePath); // throws runtime_error if not a usable snapshot
+
+        template <typename Courses>
+        static void Write(const std::string& filePath, const Courses& courses) {
+            std::vector<const Course*> ordered;
+            for (const auto& course : courses) ordered.push_back(&course);
+            write(filePath, ordered);
+        }
+        static bool IsSnapshot(const std::string& filePath); // checks the magic only
+
+        std::size_t size() const { return static_cast<std::size_t>(header.courseCount); }
+        std::string_view ID(std::size_t index) const;
+        std::string_view Name(std::size_t index) const;
+
+        // the whole strings section goes into text in one copy, names and prerequisites point into that.
+        // the graph goes first, it throws if the records aren't in order before BuildFrom relies on it
+        template <typename Courses>
+        void LoadInto(Courses& courses, CourseGraph& graph, StringArena& text) const {
+            loadGraph(graph);
+            const char* copied = text.Copy(std::string_view(strings, header.stringBytes)).data();
+            courses.BuildFrom(CourseIterator(this, 0, copied, &text), CourseIterator(this, size(), copied, &text), true);
+        }
+
+    private:
+
+        static constexpr char MAGIC[8] = { 'C', 'P', 'S', 'N', 'A', 'P', 'S', 'H' };
+        static constexpr std::uint32_t BYTE_ORDER_CHECK = 0x01020304;
+
+        std::string filePath;
+        MappedFile file;
+        Header header;
+        const Record* records;
+        const std::uint32_t* prereqs;
+        const char* strings;
+
+        static void write(const std::string& filePath, const std::vector<const Course*>& courses);
+        Course makeCourse(std::size_t index, const char* copied, StringArena& text) const;
+        void loadGraph(CourseGraph& graph) const;
+        std::string_view text(std::uint64_t offset, std::uint32_t length) const;
+        [[noreturn]] void corrupt() const;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,717 @@
+/*
+==================================================================================================
+Name        :   CatalogTests.cpp
+Author      :   Craig O'Loughlin
+Version     :   1
+Date        :   10/16/2026
+
+Description:
+
+    Regression checks for loading course files and applying change files, each one a case that
+    went wrong once. Every check writes its files next to the program, loads them and compares
+    what comes out against what should. Prints each check's result and exits with 1 if any failed.
+
+    The publish check hammers EpochPointer from several threads, it means the most built with
+    -fsanitize=thread (or =address, which catches a reader using a catalog after it was freed).
+
+    Built and run by CMakeLists.txt (ctest --test-dir build), or by hand with the program's other
+    files, minus every other main:
+        g++ -std=c++17 -O2 -pthread CatalogTests.cpp $(ls *.cpp | grep -v -e CoursePlanner -e LoadGenerator -e Benchmark -e CatalogTests)
+
+==================================================================================================
+*/
+
+#include <algorithm> // std::fill, std::swap_ranges, std::shuffle
+#include <atomic>
+#include <cmath> // std::log2
+#include <cstdint>
+#include <cstdio> // std::remove, std::snprintf
+#include <cstring> // std::memcpy
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator> // std::istreambuf_iterator
+#include <map>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BinarySearchTree.h"
+#include "Catalog.h"
+#include "CatalogQueries.h"
+#include "CatalogSnapshot.h"
+#include "CourseGraph.h"
+#include "EpochPointer.h"
+#include "FlatSearchIndex.h"
+#include "HashIndex.h"
+#include "PrereqClosure.h"
+#include "SimdKernels.h"
+
+// a failed expectation, caught by runCheck
+struct CheckFailed : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+static void expect(bool condition, const std::string& what) {
+    if (! condition) throw CheckFailed(what);
+}
+
+// write a file for one check, removed again when the check is done
+class TempFile {
+    public:
+        TempFile(const std::string& path, const std::string& text) : path(path) {
+            std::ofstream file(path, std::ios::binary);
+            file << text;
+        }
+        ~TempFile() { std::remove(path.c_str()); }
+        const std::string path;
+};
+
+// the error a load throws, empty if it loads
+static std::string loadError(const std::string& path) {
+    try {
+        Catalog::Load(path);
+    }
+    catch (std::runtime_error& e) {
+        return e.what();
+    }
+    return "";
+}
+
+/* ---------------------------------------------------------------------------------------------
+    course IDs are the same course whatever their case, in the tree and in the graph alike
+--------------------------------------------------------------------------------------------- */
+
+static void duplicateInAnotherCase() {
+    TempFile csv("check_courses.csv", "CSCI100,Intro\ncsci100,Intro Again\n");
+    std::string error = loadError(csv.path);
+    expect(error.find("(line 2)") != std::string::npos and error.find("listed more than once") != std::string::npos, "load error was: " + error);
+}
+
+static void prereqInAnotherCase() {
+    TempFile csv("check_courses.csv", "csci200,Next,CSCI100\nCSCI100,Intro\n");
+    auto catalog = Catalog::Load(csv.path);
+
+    CourseGraph::Handle intro = catalog->graph.Find("Csci100");
+    expect(catalog->graph.IsCourse(intro), "CSCI100 has no handle");
+    expect(catalog->graph.ID(intro) == "CSCI100", "graph spells it " + std::string(catalog->graph.ID(intro)));
+    expect(catalog->graph.Unlocks(intro).size() == 1 and catalog->graph.Unlocks(intro).first[0] == catalog->graph.Find("CSCI200"), "CSCI100 doesn't unlock CSCI200");
+    expect(catalog->schedule.Semester(catalog->graph.Find("csci200")) == 2, "csci200 isn't in semester 2");
+
+    // a snapshot saves prerequisites as course numbers, the lowercase one has to find CSCI100 too
+    TempFile snapshot("check_courses.snap", "");
+    CatalogSnapshot::Write(snapshot.path, catalog->courses);
+    auto reloaded = Catalog::Load(snapshot.path);
+    expect(reloaded->schedule.Semester(reloaded->graph.Find("CSCI200")) == 2, "csci200 isn't in semester 2 after the snapshot");
+}
+
+// the longest ID a course holds loads, one more character is an error on its line
+static void longestID() {
+    TempFile fits("check_courses.csv", "ABCDEFGHIJ12345,Longest\n");
+    expect(loadError(fits.path).empty(), "a 15 character ID didn't load: " + loadError(fits.path));
+
+    TempFile tooLong("check_courses.csv", "CSCI100,Intro\nABCDEFGHIJ123456,Too Long,CSCI100\n");
+    std::string error = loadError(tooLong.path);
+    expect(error.find("(line 2)") != std::string::npos and error.find("longer than 15") != std::string::npos, "load error was: " + error);
+}
+
+// load a course file, then apply a change file to it
+static std::unique_ptr<Catalog> loadAndApply(const std::string& courses, const std::string& changes) {
+    TempFile csv("check_courses.csv", courses);
+    TempFile changeFile("check_changes.csv", changes);
+    auto catalog = Catalog::Load(csv.path);
+    catalog->Apply(CatalogChanges::Read(changeFile.path));
+    return catalog;
+}
+
+static std::string list(const Catalog& catalog) {
+    std::string out;
+    CatalogQueries::List(catalog, out);
+    return out;
+}
+
+template <typename Courses>
+static std::size_t courseCount(const Courses& courses) {
+    std::size_t count = 0;
+    for (auto it = courses.begin(); it != courses.end(); ++it) count++;
+    return count;
+}
+
+static std::size_t courseCount(const Catalog& catalog) {
+    return courseCount(catalog.courses);
+}
+
+static void upsertInAnotherCase() {
+    auto catalog = loadAndApply("CSCI100,Intro\nCSCI200,Next,CSCI100\n", "csci100,Renamed\n");
+
+    const Course* course = catalog->courses.Find("CSCI100");
+    expect(course != nullptr and course->Name() == "Renamed", "find CSCI100 doesn't give the renamed course");
+    expect(course->ID() == "CSCI100", "the replaced course is spelled " + std::string(course->ID()));
+    expect(courseCount(*catalog) == 2, std::to_string(courseCount(*catalog)) + " courses in the tree");
+    expect(catalog->graph.Unlocks(catalog->graph.Find("csci100")).size() == 1, "CSCI100 lost what it unlocks");
+
+    std::string listed = list(*catalog);
+    expect(listed == "Semester 1:\nCSCI100, Renamed\n\nSemester 2:\nCSCI200, Next\n\n", "list was:\n" + listed);
+}
+
+static void deleteInAnotherCase() {
+    auto catalog = loadAndApply("CSCI100,Intro\nMATH201,Discrete\n", "-csci100\n");
+
+    expect(catalog->courses.Find("CSCI100") == nullptr, "CSCI100 is still in the tree");
+    expect(! catalog->graph.IsCourse(catalog->graph.Find("CSCI100")), "CSCI100 is still in the graph");
+    expect(courseCount(*catalog) == 1, std::to_string(courseCount(*catalog)) + " courses in the tree");
+
+    std::string listed = list(*catalog);
+    expect(listed == "Semester 1:\nMATH201, Discrete\n\n", "list was:\n" + listed);
+}
+
+// a course list orders courses of one semester by ID ignoring case, like list does
+static void courseListInAnotherCase() {
+    TempFile csv("check_courses.csv", "Math101,Calculus\ncsci200,Next\nCSCI100,Intro\nCSCI300,Algorithms,Math101,csci200,CSCI100\n");
+    auto catalog = Catalog::Load(csv.path);
+    PrereqClosure closures(catalog->graph);
+
+    std::string out;
+    CatalogQueries::Prereqs(*catalog, closures, "CSCI300", out);
+    expect(out == "CSCI300 requires: CSCI100, csci200, Math101\n", "prereqs was: " + out);
+}
+
+static void changedTwiceInAnotherCase() {
+    std::string error;
+    try {
+        loadAndApply("CSCI100,Intro\n", "CSCI100,Renamed\n-csci100\n");
+    }
+    catch (std::runtime_error& e) {
+        error = e.what();
+    }
+    expect(error.find("(line 2)") != std::string::npos and error.find("changed more than once") != std::string::npos, "apply error was: " + error);
+}
+
+/* ---------------------------------------------------------------------------------------------
+    files saved on Windows (\r\n) and files missing their last newline load like any other
+--------------------------------------------------------------------------------------------- */
+
+// the same text with \r\n line ends
+static std::string withCRLF(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '\n') out += '\r';
+        out += c;
+    }
+    return out;
+}
+
+// the text without its last newline, \r\n or \n
+static std::string withoutLastNewline(std::string text) {
+    if (! text.empty() and text.back() == '\n') text.pop_back();
+    if (! text.empty() and text.back() == '\r') text.pop_back();
+    return text;
+}
+
+// load the plain file and every variant of it, each has to list the same courses
+static void expectSameLoad(const std::string& courses, std::size_t count) {
+    TempFile plain("check_courses.csv", courses);
+    std::string expected = list(*Catalog::Load(plain.path));
+
+    for (const std::string& variant : { withCRLF(courses), withoutLastNewline(courses), withoutLastNewline(withCRLF(courses)) }) {
+        TempFile csv("check_courses.csv", variant);
+        auto catalog = Catalog::Load(csv.path);
+        expect(courseCount(*catalog) == count, std::to_string(courseCount(*catalog)) + " courses loaded, not " + std::to_string(count));
+        std::string listed = list(*catalog);
+        expect(listed == expected, "list was:\n" + listed.substr(0, 500) + "\nnot:\n" + expected.substr(0, 500));
+    }
+}
+
+static void lineEndings() {
+    // the last line's last token is a prerequisite, a \r left on it wouldn't be a course
+    expectSameLoad("CSCI100,Intro\n\nMATH201,Discrete,CSCI100\nCSCI300,Algorithms,MATH201,CSCI100\n", 3);
+
+    // enough lines that \r\n pairs fall across the reader's 256 byte scan blocks
+    std::string courses;
+    for (int i = 0; i < 2000; i++) {
+        courses += "C" + std::to_string(i) + ",Course number " + std::to_string(i);
+        if (i % 3 != 0) courses += ",C" + std::to_string(i / 3 * 3);
+        courses += (i % 50 == 0) ? "\n\n" : "\n"; // a blank line now and then
+    }
+    expectSameLoad(courses, 2000);
+
+    // errors give the same line numbers, blank lines and the unfinished last line count too
+    TempFile badName("check_courses.csv", withCRLF("CSCI100,Intro\n\nCSCI200,\nCSCI300,Algorithms"));
+    std::string error = loadError(badName.path);
+    expect(error.find("(line 3)") != std::string::npos, "load error was: " + error);
+
+    TempFile badLast("check_courses.csv", withCRLF("CSCI100,Intro\n\nCSCI200,Next\nCSCI100,Again"));
+    error = loadError(badLast.path);
+    expect(error.find("(line 4)") != std::string::npos and error.find("listed more than once") != std::string::npos, "load error was: " + error);
+
+    // change files are read the same way
+    auto changed = loadAndApply(withCRLF("CSCI100,Intro\nCSCI200,Next,CSCI100"), withCRLF("CSCI300,Algorithms,CSCI200\nCSCI100,Renamed"));
+    std::string listed = list(*changed);
+    expect(listed == "Semester 1:\nCSCI100, Renamed\n\nSemester 2:\nCSCI200, Next\n\nSemester 3:\nCSCI300, Algorithms\n\n", "list was:\n" + listed);
+}
+
+/* ---------------------------------------------------------------------------------------------
+    a big file is parsed in pieces on several threads, its errors still give the line in the file
+--------------------------------------------------------------------------------------------- */
+
+// one course line, all the same width so swapping a line for a bad one doesn't move the others
+static std::string courseLine(int number) {
+    char line[32];
+    std::snprintf(line, sizeof line, "C%06d,Course %06d", number, number);
+    return line;
+}
+
+static void lineNumbersAcrossPieces() {
+    // ~3.5MB, validate cuts files into pieces of about 1MB (MIN_CHUNK_SIZE in Catalog.cpp)
+    std::vector<std::string> lines;
+    for (int i = 0; i < 160000; i++) lines.push_back(i % 1000 == 999 ? "" : courseLine(i)); // a blank line now and then
+
+    std::string courses;
+    std::vector<std::size_t> lineStart;
+    for (const std::string& line : lines) {
+        lineStart.push_back(courses.size());
+        courses += line + "\n";
+    }
+    TempFile good("check_courses.csv", courses);
+    expect(loadError(good.path).empty(), "the file without errors didn't load: " + loadError(good.path));
+
+    // validate cuts right after the line break following size / pieces * k, so the line holding that
+    // byte is the last of one piece and the line after it the first of the next. check both, and the last line
+    std::size_t pieces = courses.size() / (1 << 20) + 1;
+    std::vector<std::size_t> checked; // indexes into lines
+    for (std::size_t k = 1; k < pieces; k++) {
+        std::size_t cut = courses.size() / pieces * k;
+        std::size_t last = std::upper_bound(lineStart.begin(), lineStart.end(), cut) - lineStart.begin() - 1;
+        checked.push_back(last);
+        checked.push_back(last + 1);
+    }
+    checked.push_back(lines.size() - 1);
+
+    for (std::size_t index : checked) {
+        if (lines[index].empty()) index--; // keep every line where it was, the bad line goes on the one before
+        std::string line = std::to_string(index + 1);
+        std::string ID = lines[index].substr(0, 7);
+
+        // each kind of error is found at a different stage: parsing a piece, collecting the pieces, the final check
+        const std::pair<std::string, std::string> badLines[] = {
+            { ID + ";Course 000000", "longer than 15" },
+            { "C000000,Course 000000", "listed more than once" },
+            { ID + ",Course,ZZZZZZ", "prerequisites do not exist" },
+        };
+        for (const auto& bad : badLines) {
+            std::string text = courses;
+            text.replace(lineStart[index], bad.first.size(), bad.first);
+            TempFile csv("check_courses.csv", text);
+
+            std::string error = loadError(csv.path);
+            expect(error.find("(line " + line + ")") != std::string::npos and error.find(bad.second) != std::string::npos,
+                   "with \"" + bad.first + "\" on line " + line + " the load error was: " + error);
+        }
+    }
+}
+
+/* ---------------------------------------------------------------------------------------------
+    the red-black tree stays balanced and in order through inserts and removes
+--------------------------------------------------------------------------------------------- */
+
+// the IDs in iteration order, space separated
+template <typename Range>
+static std::string joinIDs(const Range& courses) {
+    std::string IDs;
+    for (const auto& course : courses) {
+        IDs += course.ID();
+        IDs += ' ';
+    }
+    return IDs;
+}
+
+// the balancing rules hold and the height is within the red-black bound
+template <typename Tree>
+static void expectBalanced(const Tree& tree, std::size_t count, const std::string& when) {
+    try {
+        tree.CheckBalance();
+    }
+    catch (std::logic_error& e) {
+        throw CheckFailed(when + ": " + e.what());
+    }
+    expect(tree.Height() <= 2 * std::log2(count + 1), when + ": height " + std::to_string(tree.Height()) + " for " + std::to_string(count) + " courses");
+}
+
+static void treeInsertRemove() {
+    std::mt19937 random(11);
+    BinarySearchTree<Course> tree;
+    std::map<std::string, std::string> model; // lowercase ID -> ID, in the order the tree should have
+
+    for (int step = 1; step <= 20000; step++) {
+        std::string ID = "CS" + std::to_string(random() % 2000);
+        if (random() % 2) ID[1] = 's'; // the same course in another case now and then
+        std::string lower = ID;
+        lower[1] = 's';
+        lower[0] = 'c';
+
+        if (random() % 3 != 0) { // inserts a bit more often, so the tree grows and shrinks
+            if (model.count(lower) == 0) {
+                tree.Insert(Course(ID));
+                model[lower] = ID;
+            }
+        }
+        else {
+            bool removed = tree.Remove(ID);
+            expect(removed == (model.erase(lower) == 1), "step " + std::to_string(step) + ": Remove " + ID + " returned " + (removed ? "true" : "false"));
+        }
+
+        if (step % 500 == 0) {
+            std::string when = "step " + std::to_string(step);
+            expectBalanced(tree, model.size(), when);
+            std::string expected;
+            for (const auto& entry : model) expected += entry.second + ' ';
+            expect(joinIDs(tree) == expected, when + ": the tree holds\n" + joinIDs(tree) + "\ninstead of\n" + expected);
+        }
+    }
+
+    for (const auto& entry : model) expect(tree.Remove(entry.first), "couldn't remove " + entry.second + " at the end");
+    expect(tree.isEmpty() and tree.Height() == 0, "the tree isn't empty after removing everything");
+}
+
+// BuildFrom links the nodes up directly and colors them itself, every size has to come out a valid
+// red-black tree (and one that inserts and removes keep valid), whether the input was sorted or not
+static void buildFromColoring() {
+    std::mt19937 random(5);
+    std::vector<std::size_t> sizes;
+    for (std::size_t count = 0; count <= 130; count++) sizes.push_back(count);
+    for (std::size_t count : { 255, 256, 257, 1023, 1024, 4095, 5000 }) sizes.push_back(count);
+
+    for (std::size_t count : sizes) {
+        std::vector<Course> courses;
+        for (std::size_t i = 0; i < count; i++) courses.emplace_back("CS" + std::to_string(10000 + i));
+        std::string when = std::to_string(count) + " courses";
+
+        BinarySearchTree<Course> tree;
+        tree.BuildFrom(courses.begin(), courses.end(), true);
+        expectBalanced(tree, count, when + ", sorted");
+        std::size_t fullHeight = 0;
+        while ((std::size_t(1) << fullHeight) <= count) fullHeight++; // as short as a binary tree of count nodes can be
+        expect(tree.Height() == fullHeight, when + ": height " + std::to_string(tree.Height()) + " instead of " + std::to_string(fullHeight));
+
+        std::shuffle(courses.begin(), courses.end(), random);
+        tree.BuildFrom(courses.begin(), courses.end(), false);
+        expectBalanced(tree, count, when + ", shuffled");
+        expect(courseCount(tree) == count, when + ": " + std::to_string(courseCount(tree)) + " after building");
+
+        for (std::size_t i = 0; i < count / 2; i++) tree.Remove(courses[i].ID());
+        for (std::size_t i = 0; i < count / 4; i++) tree.Insert(Course("CS" + std::to_string(20000 + i)));
+        expectBalanced(tree, count - count / 2 + count / 4, when + ", then changed");
+    }
+}
+
+/* ---------------------------------------------------------------------------------------------
+    ordered queries: both ends of a range are included, prefixes and bounds ignore case
+--------------------------------------------------------------------------------------------- */
+
+template <typename Courses>
+static void rangeAndPrefix(const std::string& index) {
+    std::vector<Course> courses;
+    for (const char* ID : { "PHYS101", "csci200", "MATH101", "CSCI100", "Math201", "CSCI300" }) courses.emplace_back(ID);
+    Courses tree;
+    tree.BuildFrom(courses.begin(), courses.end());
+
+    auto prefix = [&tree](std::string_view start) { return joinIDs(tree.Prefix(start)); };
+    auto range = [&tree](std::string_view low, std::string_view high) { return joinIDs(tree.Range(low, high)); };
+
+    expect(prefix("csci") == "CSCI100 csci200 CSCI300 ", index + ": prefix csci was " + prefix("csci"));
+    expect(prefix("CSCI3") == "CSCI300 ", index + ": prefix CSCI3 was " + prefix("CSCI3"));
+    expect(prefix("Ma") == "MATH101 Math201 ", index + ": prefix Ma was " + prefix("Ma"));
+    expect(prefix("BIOL").empty() and prefix("Z").empty(), index + ": a prefix nothing has found something");
+    expect(prefix("") == joinIDs(tree), index + ": an empty prefix doesn't give everything");
+
+    expect(range("csci200", "MATH101") == "csci200 CSCI300 MATH101 ", index + ": range csci200-MATH101 was " + range("csci200", "MATH101"));
+    expect(range("CSCI150", "CSCI250") == "csci200 ", index + ": range CSCI150-CSCI250 was " + range("CSCI150", "CSCI250"));
+    expect(range("A", "z") == joinIDs(tree), index + ": range A-z doesn't give everything");
+    expect(range("MATH999", "CSCI100").empty(), index + ": a backwards range found something");
+    expect(range("PHYS102", "PHYS999").empty(), index + ": a range past the end found something");
+
+    expect(tree.LowerBound("math") != tree.end() and tree.LowerBound("math")->ID() == "MATH101", index + ": lower bound of math isn't MATH101");
+    expect(tree.UpperBound("csci300")->ID() == "MATH101", index + ": upper bound of csci300 isn't MATH101");
+    expect(tree.UpperBound("PHYS101") == tree.end(), index + ": upper bound of the last course isn't the end");
+}
+
+static void rangeAndPrefixQueries() {
+    rangeAndPrefix<BinarySearchTree<Course>>("tree");
+    rangeAndPrefix<FlatSearchIndex<Course>>("flat index");
+}
+
+/* ---------------------------------------------------------------------------------------------
+    the flat index answers everything the tree does, the same way, through batches of changes
+--------------------------------------------------------------------------------------------- */
+
+static void flatIndexMatchesTree() {
+    std::mt19937 random(7);
+    auto randomID = [&random] { // short, from few letters in both cases, so prefixes and near misses are common
+        std::string ID;
+        for (std::size_t length = 1 + random() % Course::MAX_ID_LENGTH; ID.size() < length; ) ID += "aAbBcC12"[random() % 8];
+        return ID;
+    };
+
+    BinarySearchTree<Course> tree;
+    FlatSearchIndex<Course> flat;
+    for (int round = 0; round < 200; round++) {
+
+        // the way Catalog::Apply changes them: a batch out, then a batch in (IDs not in either yet)
+        std::vector<std::string> out;
+        for (int i = random() % 20; i > 0; i--) out.push_back(randomID());
+        std::size_t removed = tree.RemoveEach(out.begin(), out.end());
+        expect(flat.RemoveEach(out.begin(), out.end()) == removed, "round " + std::to_string(round) + ": RemoveEach removed a different number");
+
+        for (int i = random() % 30; i > 0; i--) {
+            std::string ID = randomID();
+            if (tree.Find(ID) != nullptr) continue;
+            tree.Insert(Course(ID));
+            flat.Insert(Course(ID));
+        }
+
+        expect(joinIDs(flat) == joinIDs(tree), "round " + std::to_string(round) + ": in order they are\n" + joinIDs(tree) + "\n" + joinIDs(flat));
+        for (int query = 0; query < 20; query++) {
+            std::string ID = randomID();
+            const Course* inTree = tree.Find(ID);
+            const Course* inFlat = flat.Find(ID);
+            expect((inTree == nullptr) == (inFlat == nullptr) and (inTree == nullptr or inTree->ID() == inFlat->ID()), "find " + ID + " differs");
+
+            std::string prefix = ID.substr(0, 1 + random() % 3);
+            expect(joinIDs(flat.Prefix(prefix)) == joinIDs(tree.Prefix(prefix)), "prefix " + prefix + " differs");
+            std::string high = randomID();
+            expect(joinIDs(flat.Range(ID, high)) == joinIDs(tree.Range(ID, high)), "range " + ID + "-" + high + " differs");
+        }
+    }
+}
+
+/* ---------------------------------------------------------------------------------------------
+    the hash index still finds everything after erases shift entries back into the holes
+--------------------------------------------------------------------------------------------- */
+
+// every value lands in one of 16 homes next to each other, at the end of the smallest table, so probe
+// runs are long and wrap around past the last slot
+struct CrowdedHash {
+    std::size_t operator()(int value) const { return 56 + value % 16; }
+};
+
+static void hashIndexErase() {
+    std::mt19937 random(3);
+    std::vector<int> values(400);
+    for (int i = 0; i < 400; i++) values[i] = i;
+    HashIndex<int, CrowdedHash, std::less<>> index;
+    std::vector<bool> in(values.size(), false);
+    std::size_t count = 0;
+
+    for (int step = 1; step <= 20000; step++) {
+        std::size_t limit = (step <= 10000) ? 30 : values.size(); // first with the table at its smallest, then grown
+        std::size_t value = random() % limit;
+        if (! in[value]) {
+            index.Insert(&values[value]);
+            count++;
+        }
+        else {
+            index.Erase(&values[value]);
+            count--;
+        }
+        in[value] = ! in[value];
+
+        expect(index.size() == count, "step " + std::to_string(step) + ": size " + std::to_string(index.size()) + " instead of " + std::to_string(count));
+        for (std::size_t check = 0; check < limit; check++) {
+            const int* found = index.Find(static_cast<int>(check), std::less<>());
+            expect(found == (in[check] ? &values[check] : nullptr), "step " + std::to_string(step) + ": find " + std::to_string(check) + (in[check] ? " missed it" : " found an erased one"));
+        }
+    }
+}
+
+/* ---------------------------------------------------------------------------------------------
+    the SIMD kernels give what plain loops give. the level is picked once per run, so this checks the
+    one running; ctest runs everything again with COURSEPLANNER_SIMD=scalar, sse2 and avx2
+--------------------------------------------------------------------------------------------- */
+
+static void simdKernels() {
+    std::mt19937 random(9);
+    const std::string level = SimdKernels::LevelName(SimdKernels::Active());
+    auto fold = [](char c) { return (c >= 'A' and c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c; };
+    auto randomBytes = [&random](std::size_t length) { // every byte value, with plenty of letters, commas and newlines
+        std::string bytes;
+        const char common[] = "Aa,\nZz@[`{";
+        for (std::size_t i = 0; i < length; i++) bytes += (random() % 2) ? common[random() % 11] : static_cast<char>(random() % 256);
+        return bytes;
+    };
+
+    for (int round = 0; round < 3000; round++) {
+        std::size_t length = random() % 300;
+        std::string text = randomBytes(length);
+        std::string when = level + ", " + std::to_string(length) + " bytes";
+
+        std::uint64_t masks[SimdKernels::MASK_BYTES / 64];
+        SimdKernels::MatchMasks(text.data(), length, ',', '\n', masks);
+        for (std::size_t i = 0; i < SimdKernels::MASK_BYTES; i++) {
+            bool expected = i < length and (text[i] == ',' or text[i] == '\n');
+            expect(((masks[i / 64] >> (i % 64)) & 1) == expected, when + ": match mask bit " + std::to_string(i) + " is wrong");
+        }
+
+        std::string folded(length, '\0');
+        SimdKernels::FoldAscii(text.data(), &folded[0], length);
+        std::string inPlace = text;
+        SimdKernels::FoldAscii(&inPlace[0], &inPlace[0], length);
+        for (std::size_t i = 0; i < length; i++) {
+            expect(folded[i] == fold(text[i]) and inPlace[i] == folded[i], when + ": byte " + std::to_string(i) + " folded wrong");
+        }
+
+        // the other side is the same text in other cases, then maybe one byte changed somewhere
+        std::string other = text;
+        for (char& c : other) if (random() % 2 and c >= 'a' and c <= 'z') c = static_cast<char>(c - 'a' + 'A');
+        if (length > 0 and random() % 3 != 0) other[random() % length] = static_cast<char>(random() % 256);
+        int expected = 0;
+        for (std::size_t i = 0; i < length and expected == 0; i++) {
+            unsigned char l = static_cast<unsigned char>(fold(text[i]));
+            unsigned char r = static_cast<unsigned char>(fold(other[i]));
+            if (l != r) expected = (l < r) ? -1 : 1;
+        }
+        int compared = SimdKernels::CompareFolded(text.data(), other.data(), length);
+        expect((compared < 0) == (expected < 0) and (compared > 0) == (expected > 0), when + ": compare gave " + std::to_string(compared) + " instead of " + std::to_string(expected));
+    }
+}
+
+/* ---------------------------------------------------------------------------------------------
+    snapshots load back the same catalog, and a damaged one is turned down
+--------------------------------------------------------------------------------------------- */
+
+static const std::string SNAPSHOT_COURSES = "MATH201,Discrete,csci100\ncsci100,Intro\nCSCI300,Algorithms,MATH201,CSCI100\n";
+
+static std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static void snapshotRoundTrip() {
+    TempFile csv("check_courses.csv", SNAPSHOT_COURSES);
+    auto catalog = Catalog::Load(csv.path);
+
+    TempFile snapshot("check_courses.snap", "");
+    CatalogSnapshot::Write(snapshot.path, catalog->courses);
+    auto reloaded = Catalog::Load(snapshot.path);
+
+    expect(list(*reloaded) == list(*catalog), "list after the snapshot was:\n" + list(*reloaded));
+    expect(courseCount(*reloaded) == 3, std::to_string(courseCount(*reloaded)) + " courses in the tree");
+    const Course* course = reloaded->courses.Find("csci300");
+    expect(course != nullptr and course->Name() == "Algorithms" and course->GetPrereqs().size() == 2, "CSCI300 didn't come back whole");
+    expect(reloaded->graph.Prereqs(reloaded->graph.Find("CSCI300")).size() == 2, "CSCI300 lost its prerequisites in the graph");
+}
+
+// swap the first two records, the file is still well formed but its courses are out of order
+static void snapshotOutOfOrder() {
+    TempFile csv("check_courses.csv", SNAPSHOT_COURSES);
+    TempFile snapshot("check_courses.snap", "");
+    CatalogSnapshot::Write(snapshot.path, Catalog::Load(csv.path)->courses);
+
+    std::string bytes = readFile(snapshot.path);
+    CatalogSnapshot::Header header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    char* records = &bytes[header.recordsOffset];
+    std::swap_ranges(records, records + sizeof(CatalogSnapshot::Record), records + sizeof(CatalogSnapshot::Record));
+    TempFile swapped("check_swapped.snap", bytes);
+
+    std::string error = loadError(swapped.path);
+    expect(error.find("not a valid catalog snapshot") != std::string::npos, "load error was: " + (error.empty() ? "none, it loaded" : error));
+}
+
+/* ---------------------------------------------------------------------------------------------
+    publishing while readers are pinned, the way the server reloads its catalog
+--------------------------------------------------------------------------------------------- */
+
+// stands in for a catalog: every number is the same while it is alive, the destructor scribbles on it
+struct Published {
+    static std::atomic<int> alive;
+    std::vector<int> numbers;
+    explicit Published(int number) : numbers(64, number) { alive++; }
+    ~Published() { std::fill(numbers.begin(), numbers.end(), -1); alive--; }
+};
+std::atomic<int> Published::alive{ 0 };
+
+static void publishWhileReading() {
+    {
+        EpochPointer<Published> published(std::make_unique<Published>(0));
+        std::atomic<bool> stop{ false };
+        std::atomic<int> torn{ 0 };
+
+        std::vector<std::thread> readers;
+        for (int i = 0; i < 4; i++) {
+            readers.emplace_back([&] {
+                EpochPointer<Published>::Reader reader(published);
+                int last = 0;
+                while (! stop.load()) {
+                    auto pinned = reader.Pin();
+                    int first = pinned->numbers.front();
+                    for (int number : pinned->numbers) {
+                        if (number != first or number < last) torn++;
+                    }
+                    last = first; // a new pin never goes back to an older object
+                }
+            });
+        }
+
+        // mostly publishes, every fourth one swaps the old object back out and publishes it renumbered
+        for (int number = 1; number <= 2000; number++) {
+            if (number % 4 == 0) {
+                std::unique_ptr<Published> old = published.Exchange(std::make_unique<Published>(number));
+                std::fill(old->numbers.begin(), old->numbers.end(), ++number);
+                published.Publish(std::move(old));
+            }
+            else published.Publish(std::make_unique<Published>(number));
+        }
+        stop.store(true);
+        for (auto& reader : readers) reader.join();
+
+        expect(torn.load() == 0, std::to_string(torn.load()) + " pins saw a changed or older object");
+        expect(published.Reclaim() == 0, "objects still waiting with no reader pinned");
+        expect(Published::alive.load() == 1, std::to_string(Published::alive.load()) + " objects alive, only the current one should be");
+    }
+    expect(Published::alive.load() == 0, "the current object outlived its pointer");
+}
+
+int main() {
+
+    struct Check {
+        const char* name;
+        std::function<void()> run;
+    };
+    const std::vector<Check> checks = {
+        { "duplicate ID in another case", duplicateInAnotherCase },
+        { "prerequisite ID in another case", prereqInAnotherCase },
+        { "IDs up to 15 characters", longestID },
+        { "change file replaces an ID in another case", upsertInAnotherCase },
+        { "change file deletes an ID in another case", deleteInAnotherCase },
+        { "change file changes an ID twice in two cases", changedTwiceInAnotherCase },
+        { "course list orders IDs ignoring case", courseListInAnotherCase },
+        { "Windows line ends and no last newline", lineEndings },
+        { "line numbers in a file parsed in pieces", lineNumbersAcrossPieces },
+        { "tree stays balanced through inserts and removes", treeInsertRemove },
+        { "BuildFrom colors every size right", buildFromColoring },
+        { "range and prefix queries", rangeAndPrefixQueries },
+        { "flat index gives the tree's answers", flatIndexMatchesTree },
+        { "hash index erase keeps probe runs whole", hashIndexErase },
+        { "SIMD kernels give the plain loops' answers", simdKernels },
+        { "snapshot loads back the same catalog", snapshotRoundTrip },
+        { "snapshot with records out of order", snapshotOutOfOrder },
+        { "publish and exchange while readers are pinned", publishWhileReading },
+    };
+
+    int failed = 0;
+    for (const auto& check : checks) {
+        try {
+            check.run();
+            std::cout << "ok      " << check.name << std::endl;
+        }
+        catch (std::exception& e) {
+            std::cout << "FAILED  " << check.name << ": " << e.what() << std::endl;
+            failed++;
+        }
+    }
+    std::cout << checks.size() - failed << " of " << checks.size() << " checks passed." << std::endl;
+    return (failed == 0) ? 0 : 1;
+}
\ No newline at end of file
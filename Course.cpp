@@ -1,40 +1,158 @@
 #include "Course.h"
 
+#include <cstring> // memcmp, memset
+#include <limits>
+#include <stdexcept>
+
+#include "SimdKernels.h"
+
 /**
  * @brief Print course ID, Name followed by newline to console.
  */
-void Course::Print() {
-    std::cout << ID << ", " << Name << std::endl;
+void Course::Print() const {
+    std::string line;
+    AppendTo(line);
+    std::cout << line; // no flush, the console flushes before it waits for input anyway
 }
 
 /**
  * @brief Print all prerequisites stored in this object to console. Commas separate each object.
  */
-void Course::PrintPrereqs() {
+void Course::PrintPrereqs() const {
+    std::string line;
+    AppendPrereqsTo(line);
+    std::cout << line;
+}
+
+// same as Print, onto the end of a string (batch answers are collected in one big buffer)
+void Course::AppendTo(std::string& out) const {
+    out += ID();
+    out += ", ";
+    out += Name();
+    out += '\n';
+}
 
-    std::cout << "Prerequisites: ";
+// same as PrintPrereqs, onto the end of a string
+void Course::AppendPrereqsTo(std::string& out) const {
 
-    if (prereqs.empty()) {
-        std::cout << "None" << std::endl;
+    out += "Prerequisites: ";
+
+    if (prereqCount == 0) {
+        out += "None\n";
 
     } else {
-        for (auto iter = prereqs.begin(); iter != prereqs.end(); iter++) {
-            std::cout << *iter;
+        for (auto iter = GetPrereqs().begin(); iter != GetPrereqs().end(); iter++) {
+            out += *iter;
             // if last prereq end here else add a comma
-            if (iter == prereqs.end() - 1) {
-                std::cout << std::endl;
-            } else {
-            std::cout << ", ";
-            }
+            out += (iter == GetPrereqs().end() - 1) ? "\n" : ", ";
         }
     }
 }
 
 // convert the input string to all lowercase chars
 // see header comments
-std::string Course::lowercase(std::string input) {
-    std::string lowercaseInput;
-    for (auto c : input) lowercaseInput.push_back(std::tolower(c)); //c mean char
+std::string Course::lowercase(const std::string& input) {
+    std::string lowercaseInput(input.size(), '\0');
+    SimdKernels::FoldAscii(input.data(), &lowercaseInput[0], input.size());
     return lowercaseInput;
 }
 
+/**
+ * @brief Set the course ID and cache its lowercase comparison key.
+ */
+void Course::SetID(std::string_view ID) {
+
+    if (ID.size() > MAX_ID_LENGTH) {
+        throw std::runtime_error("Error: course ID " + std::string(ID) + " is longer than " + std::to_string(MAX_ID_LENGTH) + " characters.");
+    }
+    std::memset(id, 0, sizeof(id));
+    std::memcpy(id, ID.data(), ID.size());
+    id[MAX_ID_LENGTH] = static_cast<char>(ID.size());
+
+    MakeKey(ID, key);
+}
+
+// point the name at text kept in an arena
+void Course::SetName(std::string_view stored) {
+    if (stored.size() > std::numeric_limits<std::uint32_t>::max()) throw std::runtime_error("Error: course name is too long.");
+    name = stored.data();
+    nameLength = static_cast<std::uint32_t>(stored.size());
+}
+
+// point the prerequisites at count views kept in an arena (StringArena::CopyAll makes them)
+void Course::SetPrereqs(const std::string_view* stored, std::size_t count) {
+    if (count > std::numeric_limits<std::uint32_t>::max()) throw std::runtime_error("Error: too many prerequisites.");
+    prereqs = stored;
+    prereqCount = static_cast<std::uint32_t>(count);
+}
+
+// fold the start of an ID into a comparison key, see header
+void Course::MakeKey(std::string_view ID, char* out) {
+    std::memset(out, 0, KEY_SIZE);
+    std::memcpy(out, ID.data(), std::min(ID.size(), KEY_SIZE));
+    SimdKernels::FoldAscii(out, out, KEY_SIZE); // the whole key in one vector step
+}
+
+// FNV-1a over the lowercase ID
+std::size_t Course::Hash::operator()(std::string_view ID) const {
+
+    std::uint64_t value = 14695981039346656037ull;
+    char folded[64];
+    for (std::size_t start = 0; start < ID.size(); start += sizeof(folded)) { // fold a block at a time on the stack
+        std::size_t length = std::min(sizeof(folded), ID.size() - start);
+        SimdKernels::FoldAscii(ID.data() + start, folded, length);
+        for (std::size_t i = 0; i < length; i++) {
+            value ^= static_cast<unsigned char>(folded[i]);
+            value *= 1099511628211ull;
+        }
+    }
+    return static_cast<std::size_t>(value);
+}
+
+// the key is the ID folded already (when it fits), so it hashes the same as the ID
+std::size_t Course::Hash::operator()(const IDKey& ID) const {
+
+    std::uint64_t value = 14695981039346656037ull;
+    for (std::size_t i = 0; i < std::min(ID.length, KEY_SIZE); i++) {
+        value ^= static_cast<unsigned char>(ID.key[i]);
+        value *= 1099511628211ull;
+    }
+    return static_cast<std::size_t>(value);
+}
+
+bool Course::SameID::operator()(std::string_view lhs, std::string_view rhs) const {
+    return lhs.size() == rhs.size() and SimdKernels::CompareFolded(lhs.data(), rhs.data(), lhs.size()) == 0;
+}
+
+// <0, 0, >0 like strcmp. the cached keys hold the whole IDs
+int Course::compare(const Course& rhs) const {
+    return std::memcmp(key, rhs.key, KEY_SIZE);
+}
+
+// same as above against a plain ID. its key is folded on the stack, still nothing allocated.
+// a typed ID can be longer than the key, if the keys match it's longer than ours so it comes after
+int Course::compare(std::string_view rhsID) const {
+
+    char rhsKey[KEY_SIZE];
+    MakeKey(rhsID, rhsKey);
+
+    int result = std::memcmp(key, rhsKey, KEY_SIZE);
+    if (result != 0 or rhsID.size() <= KEY_SIZE) return result;
+    return -1;
+}
+
+// same again with the key already made, just the memcmp
+int Course::compare(const IDKey& rhsID) const {
+    int result = std::memcmp(key, rhsID.key, KEY_SIZE);
+    if (result != 0 or rhsID.length <= KEY_SIZE) return result;
+    return -1;
+}
+
+// case insensitive compare of two strings without making lowercase copies. same order as
+// comparing the lowercase strings (chars compare as unsigned, like std::string does)
+int Course::compareFolded(std::string_view lhs, std::string_view rhs) {
+
+    int result = SimdKernels::CompareFolded(lhs.data(), rhs.data(), std::min(lhs.size(), rhs.size()));
+    if (result != 0 or lhs.size() == rhs.size()) return result;
+    return (lhs.size() < rhs.size()) ? -1 : 1;
+}
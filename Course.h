@@ -9,15 +9,29 @@ Description:
 
     Object to hold the course information, along with comparison and print functions.
 
+    A course is a small fixed size object with nothing of its own on the heap: the ID is kept
+    inline, the name and prerequisites are views into a StringArena that the catalog keeps next
+    to its courses (so the arena has to outlive every course pointing into it).
+
+    Course IDs are at most MAX_ID_LENGTH (15) characters, plenty for department plus number IDs
+    like CSCI300 or even BIOL1010-LAB. Keeping the limit is what lets the ID sit inline and two
+    courses compare with one memcmp of their folded keys. A course or change file with a longer
+    ID doesn't load, the error names its line. Raising the limit means raising MAX_ID_LENGTH,
+    and KEY_SIZE with it, since every ID has to fit in its key.
+
 ==================================================================================================
 */
 
 #ifndef COURSE_H
 #define COURSE_H
 
-#include <vector>
 #include <string>
+#include <string_view>
 #include <iostream>
+#include <cstddef>
+#include <cstdint>
+#include <cstring> // memcpy
+#include <algorithm> // std::min
 
 /** @brief A handy collection of fields and functions to hold information about a college course.
  */
@@ -25,33 +39,134 @@ class Course {
 
     public:
 
+        static constexpr std::size_t MAX_ID_LENGTH = 15; // longer IDs are turned down by SetID
+
+        // the prerequisite IDs, a run of views in the arena
+        struct Prereqs {
+            const std::string_view* first;
+            const std::string_view* last;
+            const std::string_view* begin() const { return first; }
+            const std::string_view* end() const { return last; }
+            std::size_t size() const { return last - first; }
+            bool empty() const { return first == last; }
+        };
+
+        Course() = default;
+        explicit Course(std::string_view ID) { SetID(ID); }
+
         // fields
-        std::string ID;
-        std::string Name;
-        std::vector<std::string> prereqs;
+        std::string_view ID() const { return std::string_view(id, id[MAX_ID_LENGTH]); }
+        std::string_view Name() const { return std::string_view(name, nameLength); }
+        Prereqs GetPrereqs() const { return { prereqs, prereqs + prereqCount }; }
 
-        // operator overloads: convert to lowercase and compare by ID
+        void SetID(std::string_view ID); // throws runtime_error if longer than MAX_ID_LENGTH
+        void SetName(std::string_view stored);                               // these two keep the views, not the text:
+        void SetPrereqs(const std::string_view* stored, std::size_t count); // it has to live in an arena (StringArena.h)
+
+        // operator overloads: compare by ID ignoring case
         // i ref https://stackoverflow.com/questions/313970/how-to-convert-an-instance-of-stdstring-to-lower-case
         // "ascii only"
-        
-        std::string lowercase(std::string input);
 
-        bool operator<(const Course& rhs) {
-            return lowercase(this->ID) < lowercase(rhs.ID);
+        static std::string lowercase(const std::string& input);
+
+        bool operator<(const Course& rhs) const {
+            return compare(rhs) < 0;
         }
-        bool operator==(const Course& rhs) {
-            return lowercase(this->ID) == lowercase(rhs.ID);
+        bool operator==(const Course& rhs) const {
+            return compare(rhs) == 0;
         }
 
+        // compare straight against an ID string (lets the tree Find by ID without building a Course)
+        friend bool operator<(const Course& lhs, std::string_view rhs) { return lhs.compare(rhs) < 0; }
+        friend bool operator<(std::string_view lhs, const Course& rhs) { return rhs.compare(lhs) > 0; }
+
+        /* Compares equal to every course whose ID starts with the prefix (ignoring case), less than
+        the ones before and greater than the ones after. Courses sharing a prefix are next to each
+        other in ID order, so this gives the tree all of them as one range:
+            for (const auto& course : courses.Prefix("CSCI3")) ...
+        */
+        struct PrefixKey {
+            std::string_view prefix;
+            explicit PrefixKey(std::string_view prefix) : prefix(prefix) {}
+        };
+        friend bool operator<(const Course& lhs, const PrefixKey& rhs) { return lhs.comparePrefix(rhs.prefix) < 0; }
+        friend bool operator<(const PrefixKey& lhs, const Course& rhs) { return rhs.comparePrefix(lhs.prefix) > 0; }
+
+        /* The first KEY_SIZE chars of an ID, lowercase and zero padded, as used for comparing. Keys
+        compare with memcmp in the same order as the courses themselves, only IDs with equal keys
+        need a full compare. FlatSearchIndex keeps these instead of the courses for its searches.
+        Any key a course can be compared against has one (for a PrefixKey it's the smallest key
+        that can start with that prefix).
+        */
+        static constexpr std::size_t KEY_SIZE = 16;
+        static void MakeKey(const Course& course, char* out) { std::memcpy(out, course.key, KEY_SIZE); }
+        static void MakeKey(std::string_view ID, char* out);
+        static void MakeKey(const PrefixKey& key, char* out) { MakeKey(key.prefix, out); }
+
+        /* A typed ID with its key made once up front. Comparing against a plain ID string folds it again
+        for every course it meets on the way down the tree, a lookup made with this folds it once:
+            courses.Find(Course::IDKey(ID))
+        Worth it when looking up lots of IDs (batch queries), or keeping the keys around to sort them.
+        */
+        struct IDKey {
+            char key[KEY_SIZE];
+            std::size_t length; // of the ID, which can be longer than the key
+            explicit IDKey(std::string_view ID) : length(ID.size()) { MakeKey(ID, key); }
+        };
+        friend bool operator<(const Course& lhs, const IDKey& rhs) { return lhs.compare(rhs) < 0; }
+        friend bool operator<(const IDKey& lhs, const Course& rhs) { return rhs.compare(lhs) > 0; }
+        static void MakeKey(const IDKey& ID, char* out) { std::memcpy(out, ID.key, KEY_SIZE); }
+
+        // hash of the ID ignoring case, so it agrees with the comparisons (for the tree's optional hash index)
+        struct Hash {
+            std::size_t operator()(const Course& course) const { return (*this)(course.ID()); }
+            std::size_t operator()(std::string_view ID) const;
+            std::size_t operator()(const IDKey& ID) const; // same as the ID's, from the key (longer IDs than that can't match anyway)
+        };
+
+        // the equality that goes with Hash, for hash maps keyed by plain IDs
+        struct SameID {
+            bool operator()(std::string_view lhs, std::string_view rhs) const;
+        };
+
+        // the tree's order for plain IDs (ignoring case), for sorting IDs that aren't in a Course
+        struct IDLess {
+            bool operator()(std::string_view lhs, std::string_view rhs) const { return compareFolded(lhs, rhs) < 0; }
+        };
+
         // stream overload
         friend std::ostream& operator<<(std::ostream& os, const Course& course) {
-            os << course.ID << ", " << course.Name;
+            os << course.ID() << ", " << course.Name();
             return os;
         }
 
         // printing functions
-        void Print();
-        void PrintPrereqs();
+        void Print() const;
+        void PrintPrereqs() const;
+        void AppendTo(std::string& out) const;        // the same text as Print/PrintPrereqs,
+        void AppendPrereqsTo(std::string& out) const; // added to the end of out instead
+
+    private:
+
+        // the ID as given, zero padded. the last byte is its length
+        char id[MAX_ID_LENGTH + 1] = {};
+
+        /* Comparisons used to lowercase both IDs (four new strings) every time the tree compared two
+        courses. Now SetID folds the ID once into this fixed buffer, zero padded, and two courses
+        compare with a single memcmp. Every ID fits in the buffer, so that always settles it.
+        */
+        char key[KEY_SIZE] = {};
+
+        const char* name = nullptr;
+        std::uint32_t nameLength = 0;
+        std::uint32_t prereqCount = 0;
+        const std::string_view* prereqs = nullptr;
+
+        int compare(const Course& rhs) const;
+        int compare(std::string_view rhsID) const;
+        int compare(const IDKey& rhsID) const;
+        int comparePrefix(std::string_view prefix) const { return compareFolded(ID().substr(0, prefix.size()), prefix); }
+        static int compareFolded(std::string_view lhs, std::string_view rhs);
 };
 
 #endif
\ No newline at end of file
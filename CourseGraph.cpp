@@ -0,0 +1,309 @@
+#include "CourseGraph.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "SimdKernels.h"
+
+// equal ignoring case, like the tree's comparison
+static bool sameID(std::string_view lhs, std::string_view rhs) {
+    return lhs.size() == rhs.size() and SimdKernels::CompareFolded(lhs.data(), rhs.data(), lhs.size()) == 0;
+}
+
+/**
+ * @brief Add a course (its line in the input file is kept for error messages). If it was already
+ * named as a prerequisite it keeps the handle it got then, and its ID is spelled the course's way now.
+ *
+ * @return the course's handle, or NONE if this course (in any case) was added before
+ */
+CourseGraph::Handle CourseGraph::AddCourse(std::string_view ID, int line) {
+
+    Handle course = intern(ID);
+    if (definedLine[course] != 0) return NONE;
+
+    std::copy(ID.begin(), ID.end(), idText.begin() + idStart[course]); // same length, only the case can differ
+    definedLine[course] = (line > 0) ? line : -1; // anything but 0 means defined
+    return course;
+}
+
+// note that 'course' requires the course with prereqID, which may not have been added yet
+void CourseGraph::AddPrereq(Handle course, std::string_view prereqID, int line) {
+
+    Handle prereq = intern(prereqID);
+    if (firstReferenceLine[prereq] == 0) firstReferenceLine[prereq] = line;
+    stagedEdges.emplace_back(course, prereq);
+}
+
+// same, for a prereq that already has a handle
+void CourseGraph::AddPrereq(Handle course, Handle prereq) {
+    stagedEdges.emplace_back(course, prereq);
+}
+
+// every handle is either a course or only ever mentioned as a prereq, the latter are missing courses
+int CourseGraph::FirstMissingPrereqLine() const {
+
+    int first = 0;
+    for (std::size_t course = 0; course < definedLine.size(); course++) {
+        if (definedLine[course] == 0 and (first == 0 or firstReferenceLine[course] < first)) {
+            first = firstReferenceLine[course];
+        }
+    }
+    return first;
+}
+
+/**
+ * @brief Pack the prereqs added so far into one array grouped by course (a counting sort, linear).
+ * Each course keeps its prereqs in the order they were added. Then the reverse index is rebuilt from
+ * that the same way.
+ */
+void CourseGraph::Finalize() {
+
+    if (stagedEdges.size() + edgeCount > 0xFFFFFFFFull) throw std::runtime_error("Error: too many prerequisites.");
+
+    // start with the prereqs from any earlier Finalize, then count how many each course gets
+    prereqRuns.resize(size());
+    std::vector<Run> runs(size());
+    for (Handle course = 0; course < size(); course++) runs[course].count = prereqRuns[course].count;
+    for (auto& edge : stagedEdges) runs[edge.first].count++;
+
+    std::uint32_t start = 0;
+    for (auto& run : runs) {
+        run.start = start;
+        run.capacity = run.count;
+        start += run.count;
+    }
+
+    std::vector<Handle> list(start);
+    std::vector<std::uint32_t> next(size());
+    for (Handle course = 0; course < size(); course++) {
+        next[course] = runs[course].start;
+        for (Handle prereq : Prereqs(course)) list[next[course]++] = prereq;
+    }
+    for (auto& edge : stagedEdges) list[next[edge.first]++] = edge.second;
+
+    prereqRuns.swap(runs);
+    prereqList.swap(list);
+    edgeCount = prereqList.size();
+    stagedEdges.clear();
+    stagedEdges.shrink_to_fit();
+
+    // reverse: count how many courses list each prereq, then drop every course in under its prereqs
+    std::vector<Run> reverseRuns(size());
+    for (Handle prereq : prereqList) reverseRuns[prereq].count++;
+    start = 0;
+    for (auto& run : reverseRuns) {
+        run.start = start;
+        run.capacity = run.count;
+        start += run.count;
+    }
+
+    std::vector<Handle> reverseList(prereqList.size());
+    for (Handle course = 0; course < size(); course++) next[course] = reverseRuns[course].start;
+    for (Handle course = 0; course < size(); course++) {
+        for (Handle prereq : Prereqs(course)) reverseList[next[prereq]++] = course;
+    }
+
+    unlockRuns.swap(reverseRuns);
+    unlockList.swap(reverseList);
+}
+
+/**
+ * @brief Replace the prereqs of a course after Finalize (a course added since then starts with none),
+ * and fix the reverse index to match. Only the old and new prereqs and their unlock lists are touched.
+ *
+ * A run that gets longer than it has room for moves to the end of its list, the reverse runs with room
+ * to spare so a popular prereq isn't moved on every change. The space left behind is reclaimed all at
+ * once when it gets to be more than the graph itself, so that costs nothing extra amortized either.
+ */
+void CourseGraph::SetPrereqs(Handle course, const std::vector<Handle>& prereqs) {
+
+    prereqRuns.resize(size());
+    unlockRuns.resize(size());
+    Run& run = prereqRuns[course];
+
+    for (std::uint32_t i = 0; i < run.count; i++) erase(unlockRuns[prereqList[run.start + i]], unlockList, course);
+    edgeCount -= run.count;
+
+    if (prereqs.size() > run.capacity) moveToEnd(run, prereqList, prereqs.size());
+    std::copy(prereqs.begin(), prereqs.end(), prereqList.begin() + run.start);
+    run.count = static_cast<std::uint32_t>(prereqs.size());
+    edgeCount += run.count;
+
+    for (Handle prereq : prereqs) append(unlockRuns[prereq], unlockList, course);
+
+    if (prereqList.size() + unlockList.size() > 4 * edgeCount + 1024) {
+        pack(prereqRuns, prereqList);
+        pack(unlockRuns, unlockList);
+    }
+}
+
+// the course is gone but its ID stays interned, adding it again later gets the same handle back
+void CourseGraph::RemoveCourse(Handle course) {
+    SetPrereqs(course, {});
+    definedLine[course] = 0;
+    firstReferenceLine[course] = 0;
+}
+
+// give a run a new home at the end of list with room for capacity handles, its old space is left unused
+void CourseGraph::moveToEnd(Run& run, std::vector<Handle>& list, std::size_t capacity) {
+
+    if (list.size() + capacity > 0xFFFFFFFFull) throw std::runtime_error("Error: too many prerequisites.");
+
+    std::uint32_t start = static_cast<std::uint32_t>(list.size());
+    list.resize(list.size() + capacity);
+    std::copy(list.begin() + run.start, list.begin() + run.start + run.count, list.begin() + start);
+    run.start = start;
+    run.capacity = static_cast<std::uint32_t>(capacity);
+}
+
+void CourseGraph::append(Run& run, std::vector<Handle>& list, Handle value) {
+    if (run.count == run.capacity) moveToEnd(run, list, std::max<std::size_t>(4, run.capacity * std::size_t(2)));
+    list[run.start + run.count++] = value;
+}
+
+// take value out of the run, the rest keep their order
+void CourseGraph::erase(Run& run, std::vector<Handle>& list, Handle value) {
+    auto first = list.begin() + run.start;
+    auto last = first + run.count;
+    auto found = std::find(first, last, value);
+    if (found == last) return;
+    std::copy(found + 1, last, found);
+    run.count--;
+}
+
+// copy every run back to back with no room to spare, dropping the space moved runs left behind
+void CourseGraph::pack(std::vector<Run>& runs, std::vector<Handle>& list) {
+
+    std::vector<Handle> packed;
+    packed.reserve(list.size());
+    for (auto& run : runs) {
+        std::uint32_t start = static_cast<std::uint32_t>(packed.size());
+        packed.insert(packed.end(), list.begin() + run.start, list.begin() + run.start + run.count);
+        run.start = start;
+        run.capacity = run.count;
+    }
+    list.swap(packed);
+}
+
+// handle for an ID, NONE if it isn't in the graph
+CourseGraph::Handle CourseGraph::Find(std::string_view ID) const {
+    if (slots.empty()) return NONE;
+    return slots[findSlot(ID)];
+}
+
+std::string_view CourseGraph::ID(Handle course) const {
+    return std::string_view(idText.data() + idStart[course], idStart[course + 1] - idStart[course]);
+}
+
+CourseGraph::Handles CourseGraph::Prereqs(Handle course) const {
+    if (course >= prereqRuns.size()) return { nullptr, nullptr }; // added after the last Finalize
+    const Handle* first = prereqList.data() + prereqRuns[course].start;
+    return { first, first + prereqRuns[course].count };
+}
+
+CourseGraph::Handles CourseGraph::Unlocks(Handle course) const {
+    if (course >= unlockRuns.size()) return { nullptr, nullptr };
+    const Handle* first = unlockList.data() + unlockRuns[course].start;
+    return { first, first + unlockRuns[course].count };
+}
+
+/**
+ * @brief Every course that needs this one, directly or through other courses (breadth first, nearest
+ * first). Only the courses found and their edges are touched.
+ */
+std::vector<CourseGraph::Handle> CourseGraph::AllUnlocks(Handle course) const {
+
+    // every thread marks with stamps of its own, so any number of them can ask at once. the generation
+    // is new on every call, stamps left over from another graph never look current
+    thread_local std::vector<std::uint32_t> seenStamp;
+    thread_local std::uint32_t generation = 0;
+
+    if (seenStamp.size() < size()) seenStamp.resize(size(), 0);
+    if (++generation == 0) { // wrapped around, old stamps could look current
+        std::fill(seenStamp.begin(), seenStamp.end(), 0);
+        generation = 1;
+    }
+
+    std::vector<Handle> found; // doubles as the queue
+    seenStamp[course] = generation;
+    Handle from = course;
+    for (std::size_t i = 0; ; from = found[i++]) {
+        for (Handle next : Unlocks(from)) {
+            if (seenStamp[next] != generation) {
+                seenStamp[next] = generation;
+                found.push_back(next);
+            }
+        }
+        if (i == found.size()) break; // everything found has been expanded
+    }
+    return found;
+}
+
+void CourseGraph::Clear() {
+    CourseGraph empty;
+    Swap(empty);
+}
+
+void CourseGraph::Swap(CourseGraph& other) noexcept {
+    idText.swap(other.idText);
+    idStart.swap(other.idStart);
+    slots.swap(other.slots);
+    definedLine.swap(other.definedLine);
+    firstReferenceLine.swap(other.firstReferenceLine);
+    stagedEdges.swap(other.stagedEdges);
+    prereqRuns.swap(other.prereqRuns);
+    prereqList.swap(other.prereqList);
+    unlockRuns.swap(other.unlockRuns);
+    unlockList.swap(other.unlockList);
+    std::swap(edgeCount, other.edgeCount);
+}
+
+// handle for an ID, giving it the next handle if it's new
+CourseGraph::Handle CourseGraph::intern(std::string_view ID) {
+
+    if (slots.empty() or (size() + 1) * 2 > slots.size()) growSlots(); // keep the table at most half full
+
+    std::size_t slot = findSlot(ID);
+    if (slots[slot] != NONE) return slots[slot];
+
+    if (size() == NONE) throw std::runtime_error("Error: too many courses.");
+    Handle course = static_cast<Handle>(size());
+    slots[slot] = course;
+
+    idText.append(ID);
+    idStart.push_back(idText.size());
+    definedLine.push_back(0);
+    firstReferenceLine.push_back(0);
+    return course;
+}
+
+// linear probe from the ID's hash to the slot holding it (in any case), or to the empty slot where it would go
+std::size_t CourseGraph::findSlot(std::string_view ID) const {
+
+    std::size_t mask = slots.size() - 1;
+    std::size_t slot = hash(ID) & mask;
+    while (slots[slot] != NONE and ! sameID(this->ID(slots[slot]), ID)) slot = (slot + 1) & mask;
+    return slot;
+}
+
+// double the table (starting at 64 slots) and put every handle back in
+void CourseGraph::growSlots() {
+
+    std::vector<Handle> old;
+    old.swap(slots);
+    slots.assign(old.empty() ? 64 : old.size() * 2, NONE);
+
+    for (Handle course : old) {
+        if (course != NONE) slots[findSlot(ID(course))] = course;
+    }
+}
+
+// 64 bit FNV-1a of the lowercase ID
+std::uint64_t CourseGraph::hash(std::string_view ID) {
+    std::uint64_t value = 14695981039346656037ull;
+    for (char c : ID) {
+        value ^= static_cast<unsigned char>(SimdKernels::FoldByte(c));
+        value *= 1099511628211ull;
+    }
+    return value;
+}
\ No newline at end of file
@@ -0,0 +1,139 @@
+/*
+==================================================================================================
+Name        :   CourseGraph.h
+Author      :   Craig O'Loughlin
+Version     :   1
+Date        :   10/16/2026
+
+Description:
+
+    The prerequisite relationships between courses as a graph of plain integers. Every course ID
+    is interned once to a dense handle (0, 1, 2 ...), and each course's prerequisites are stored
+    as a run of handles in one shared array (compressed sparse row). The same is kept the other
+    way around, which courses list a course as a prerequisite, so "what does this unlock" never
+    has to scan every course. Built next to the tree while loading, and used for everything that
+    follows prerequisites around. A change file can add, replace and delete courses afterwards
+    without building it again (SetPrereqs, RemoveCourse).
+
+==================================================================================================
+*/
+
+#ifndef COURSEGRAPH_H
+#define COURSEGRAPH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Interned course IDs plus prerequisite adjacency. IDs match ignoring case, the same way the
+ * tree compares courses, so every ID the tree would call the same course has the one handle. The ID
+ * kept for a handle is spelled the way its course line spells it (or its first mention until then).
+ *
+ * Building:
+ *      Handle course = graph.AddCourse("CSCI300", line);
+ *      graph.AddPrereq(course, "CSCI200", line);   // fine before CSCI200 itself is added
+ *      ...
+ *      if (graph.FirstMissingPrereqLine() == 0) graph.Finalize();
+ *
+ * Changing afterwards:
+ *      graph.SetPrereqs(graph.AddCourse("CSCI400", line), { graph.Find("CSCI300") });
+ *      graph.RemoveCourse(graph.Find("CSCI100"));  // nothing may list it as a prereq any more
+ *
+ * Intern/Find: O(1) average
+ * Prereqs/Unlocks: O(1), a contiguous run of handles
+ * AllUnlocks: O(courses found + their edges), no matter how big the graph is
+ * SetPrereqs/RemoveCourse: O(old + new prereqs + the unlock lists of those prereqs), amortized
+ *
+ * Once finalized every query is read only, any number of threads can share one graph. Changing it
+ * is not, a graph has to be out of every reader's sight while it changes.
+ */
+class CourseGraph {
+
+    public:
+
+        using Handle = std::uint32_t;
+        static constexpr Handle NONE = 0xFFFFFFFF;
+
+        // a run of handles, for range based for loops
+        struct Handles {
+            const Handle* first;
+            const Handle* last;
+            const Handle* begin() const { return first; }
+            const Handle* end() const { return last; }
+            std::size_t size() const { return last - first; }
+            bool empty() const { return first == last; }
+        };
+
+        // building
+        Handle AddCourse(std::string_view ID, int line); // NONE if that course was already added
+        void AddPrereq(Handle course, std::string_view prereqID, int line);
+        void AddPrereq(Handle course, Handle prereq);
+        int FirstMissingPrereqLine() const; // first line naming a prereq that never got added as a course, 0 if none
+        void Finalize();
+
+        // changing (after Finalize)
+        void SetPrereqs(Handle course, const std::vector<Handle>& prereqs); // replaces the course's prereqs
+        void RemoveCourse(Handle course); // back to only an interned ID. must not be anyone's prereq
+
+        // queries (after Finalize)
+        std::size_t size() const { return definedLine.size(); } // handles, removed courses included
+        std::size_t EdgeCount() const { return edgeCount; }
+        bool IsCourse(Handle course) const { return course < size() and definedLine[course] != 0; } // false for NONE too
+        Handle Find(std::string_view ID) const;
+        std::string_view ID(Handle course) const;
+        Handles Prereqs(Handle course) const;
+        Handles Unlocks(Handle course) const; // courses listing this one as a prereq
+        std::vector<Handle> AllUnlocks(Handle course) const; // direct or not
+
+        void Clear();
+        void Swap(CourseGraph& other) noexcept;
+
+    private:
+
+        // interned IDs, back to back. handle h is idText[idStart[h], idStart[h + 1])
+        std::string idText;
+        std::vector<std::uint64_t> idStart = { 0 };
+
+        // open addressing table of handles (NONE = empty slot), keyed by a hash of the ID
+        std::vector<Handle> slots;
+
+        // per handle: line the course was added on (0 if only seen as a prereq so far), and
+        // the first line naming it as a prereq
+        std::vector<int> definedLine;
+        std::vector<int> firstReferenceLine;
+
+        // a handle's run in one of the lists below: list[start, start + count), with room for capacity
+        struct Run {
+            std::uint32_t start = 0;
+            std::uint32_t count = 0;
+            std::uint32_t capacity = 0;
+        };
+
+        // (course, prereq) pairs while building, turned into prereqRuns/prereqList by Finalize.
+        // prereqs of handle h are prereqRuns[h]'s run of prereqList
+        std::vector<std::pair<Handle, Handle>> stagedEdges;
+        std::vector<Run> prereqRuns;
+        std::vector<Handle> prereqList;
+
+        // the same edges reversed, rebuilt by Finalize. courses unlocked by h are unlockRuns[h]'s run of unlockList
+        std::vector<Run> unlockRuns;
+        std::vector<Handle> unlockList;
+
+        // edges in the graph. the lists can hold more than this, runs that SetPrereqs moved leave their old space behind
+        std::size_t edgeCount = 0;
+
+        static void moveToEnd(Run& run, std::vector<Handle>& list, std::size_t capacity);
+        static void append(Run& run, std::vector<Handle>& list, Handle value);
+        static void erase(Run& run, std::vector<Handle>& list, Handle value);
+        static void pack(std::vector<Run>& runs, std::vector<Handle>& list);
+        Handle intern(std::string_view ID);
+        std::size_t findSlot(std::string_view ID) const;
+        void growSlots();
+        static std::uint64_t hash(std::string_view ID);
+};
+
+#endif
\ No newline at end of file
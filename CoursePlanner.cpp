@@ -9,7 +9,25 @@ Description:
 
     Console program that loads a given CSV file of course information into memory. Allows
     user to search the course information, print specific course information via a query,
-    and print all courses in alphanumeric order by ID.
+    check whether a student's completed courses cover everything a course requires, see what
+    a course unlocks (and what retiring it would break), list the courses in a department or
+    an ID range, and print all courses as a semester by semester schedule that never puts a
+    course before its prerequisites. The loaded courses can be saved as a binary snapshot that
+    loads back without parsing or sorting them again (CatalogSnapshot.h), and a change file can
+    add, replace or delete a few courses without loading everything again.
+
+    Usage: CoursePlanner [file to load at startup]
+           CoursePlanner file --batch commands|- [--sort]
+           CoursePlanner file --serve socket [--workers n]
+
+    The second form answers a file (or stdin) full of commands without the menu, see
+    CatalogQueries.h for what they are. The third answers the same commands for other programs
+    over a Unix domain socket until Ctrl+C, and loads the file again whenever it gets SIGHUP
+    while it goes on answering (QueryServer.h, LoadGenerator.cpp is a client).
+
+    Built with CMakeLists.txt (cmake -S . -B build && cmake --build build), or by hand with the
+    other files, minus the tools' mains:
+        g++ -std=c++17 -O2 -pthread $(ls *.cpp | grep -v -e LoadGenerator -e Benchmark -e CatalogTests) -o CoursePlanner
 
 ==================================================================================================
 */
@@ -18,38 +36,87 @@ Description:
 #include <iostream>
 #include <vector>
 #include <string>
-#include <unordered_map> // local validCourses in validation algorithm
 #include <limits> // numeric_limits , for clearing cin
-#include <random> // shuffling data objects
-#include <algorithm> // std::shuffle
+#include <memory>
+#include <string_view>
+#include <algorithm> // std::min, std::sort
+#include <fstream>
+#include <chrono> // timing batch runs
+#include <cstdlib> // strtoul
 
 // custom library includes
 #include "Course.h"
+#include "Catalog.h"
 #include "CSVFileReader.h"
-#include "BinarySearchTree.h"
+#include "CatalogSnapshot.h"
+#include "CatalogQueries.h"
+#include "CourseGraph.h"
+#include "EpochPointer.h"
+#include "PrereqClosure.h"
+#include "QueryServer.h"
 
 // function declarations
-Course newCourse();
-std::vector<Course> validate(CSVFileReader& csv);
-void checkPrereqs(std::vector<Course> coursesVec, std::unordered_map<std::string, bool>& validCourses);
+int runBatch(const std::string& catalogPath, const std::string& commandsPath, bool sortLookups);
+int runServer(const std::string& catalogPath, const std::string& socketPath, std::size_t workers);
 bool mainMenu();
 void PrintCourseList();
 void LoadDataStructure();
-void buildCourses(std::vector<Course> courses);
+void LoadDataStructure(const std::string& filePath);
+void ApplyChanges();
+void SaveSnapshot();
 void PrintCourse();
+void CheckEligibility();
+void PrintUnlocks();
+void PrintCourseRange();
+PrereqClosure& closuresFor(const Catalog& catalog);
 void MenuOptions();
 void GetInputInt(int& choice);
 bool invalidIntInput(int& choice);
 std::string getFilePath();
 
-// our chosen data structure
-BinarySearchTree<Course> courses;
+/* The loaded catalog (courses, prerequisite graph, schedule). Loading builds a whole new catalog and
+publishes it, it never changes one in place. Anything reading pins the catalog it started with and
+keeps it until done, even if a new one is published meanwhile, so readers never wait on a load or
+see a half built catalog. The old catalog is freed once nothing has it pinned.
+*/
+EpochPointer<Catalog> published(std::make_unique<Catalog>());
+
+// this (the console) thread's reader slot
+EpochPointer<Catalog>::Reader console(published);
 
-// entry point
-int main() {
+/* Change files don't build a new catalog, they change one in place, and only a catalog no reader can see
+may change. So there are two copies taking turns (left-right): the changes go into this spare copy, it is
+published, and once every reader has moved off the other copy that one gets the same changes and becomes
+the spare. Each change file costs about what it changes, not a reload. The spare is copied from the
+published catalog the first time a change file is applied, and dropped by a full load.
+*/
+std::unique_ptr<Catalog> spare;
+
+// everything required before each course, worked out as it gets asked for (see closuresFor)
+PrereqClosure closures;
+std::uint64_t closuresVersion = 0;
+
+// entry point. an optional file (csv or snapshot) on the command line is loaded right away
+int main(int argc, char* argv[]) {
+
+    // batch and server modes: no menu, just the answers (see the usage at the top)
+    std::string catalogPath, commandsPath, socketPath;
+    bool batch = false, serve = false, sortLookups = false;
+    std::size_t workers = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--batch" and i + 1 < argc) { batch = true; commandsPath = argv[++i]; }
+        else if (arg == "--serve" and i + 1 < argc) { serve = true; socketPath = argv[++i]; }
+        else if (arg == "--workers" and i + 1 < argc) workers = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--sort") sortLookups = true;
+        else catalogPath = arg;
+    }
+    if (batch) return runBatch(catalogPath, commandsPath, sortLookups);
+    if (serve) return runServer(catalogPath, socketPath, workers);
 
     try {
         std::cout << "Welcome to the course planner." << std::endl;
+        if (! catalogPath.empty()) LoadDataStructure(catalogPath);
         while(mainMenu()); //main program loop
     } 
     catch (std::exception genError) {
@@ -65,6 +132,11 @@ void MenuOptions() {
     std::cout << "1. Load Data Structure." << "\n";
     std::cout << "2. Print Course List." << "\n";
     std::cout << "3. Print Course." << "\n";
+    std::cout << "4. Save Snapshot." << "\n";
+    std::cout << "5. Check Eligibility." << "\n";
+    std::cout << "6. Print What a Course Unlocks." << "\n";
+    std::cout << "7. Print Courses by Prefix or Range." << "\n";
+    std::cout << "8. Apply Change File." << "\n";
     std::cout << "9. Exit" << "\n";
     std::cout << std::endl;
 
@@ -96,6 +168,26 @@ bool mainMenu() {
             PrintCourse(); // checks for data before running
             break;
 
+        case 4:
+            SaveSnapshot(); // checks for data before running
+            break;
+
+        case 5:
+            CheckEligibility(); // checks for data before running
+            break;
+
+        case 6:
+            PrintUnlocks(); // checks for data before running
+            break;
+
+        case 7:
+            PrintCourseRange(); // checks for data before running
+            break;
+
+        case 8:
+            ApplyChanges(); // checks for data before running
+            break;
+
         case 9:
             std::cout << "Thank you for using the course planner!" << std::endl;
             return false; // quit condition
@@ -126,20 +218,141 @@ bool invalidIntInput(int& choice) {
             !( std::cin.peek() == EOF or std::cin.peek() == '\n');      // or if the next char is not newline or end of line
 }
 
-// get the file path from user, parse by comma, validate, and build the data structure
+/**
+ * @brief Load a catalog and answer a file of commands against it (CatalogQueries), no menu. The answers go
+ * to stdout, anything else (errors, how long it took) to stderr so it doesn't mix in with them.
+ *
+ * @param commandsPath the commands, "-" to read them from stdin
+ * @return exit code, 1 if the catalog or the commands can't be read
+ */
+int runBatch(const std::string& catalogPath, const std::string& commandsPath, bool sortLookups) {
+
+    std::ios::sync_with_stdio(false); // cin/cout unhooked from C stdio, they are much faster in bulk that way
+
+    std::unique_ptr<Catalog> catalog;
+    try {
+        catalog = Catalog::Load(catalogPath); // throws runtime errors
+    }
+    catch (std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    std::ifstream file;
+    if (commandsPath != "-") {
+        file.open(commandsPath, std::ios::binary);
+        if (! file) {
+            std::cerr << "Error opening file: " << commandsPath << std::endl;
+            return 1;
+        }
+    }
+    std::istream& commands = (commandsPath == "-") ? std::cin : file;
+
+    auto start = std::chrono::steady_clock::now();
+    std::size_t count = CatalogQueries::RunBatch(*catalog, commands, std::cout, sortLookups);
+    auto took = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    std::cerr << count << " commands answered in " << took.count() << " ms." << std::endl;
+    return 0;
+}
+
+/**
+ * @brief Server mode: load the catalog, publish it and answer queries on the socket until Ctrl+C
+ * (or SIGTERM). The workers pin the published catalog like the menu does, and SIGHUP loads the file
+ * again and publishes it while they keep answering.
+ *
+ * @param workers worker threads, 0 for one per hardware thread
+ * @return exit code, 1 if the catalog can't be read or the socket can't be set up
+ */
+int runServer(const std::string& catalogPath, const std::string& socketPath, std::size_t workers) {
+
+    try {
+        std::unique_ptr<Catalog> loaded = Catalog::Load(catalogPath); // throws runtime errors
+        std::size_t courseCount = loaded->graph.size();
+        published.Publish(std::move(loaded));
+
+        QueryServer server(published, socketPath, workers);
+
+        // SIGHUP: load the file again off to the side and publish it, the workers never stop answering
+        server.OnReload([&catalogPath] {
+            auto start = std::chrono::steady_clock::now();
+            try {
+                std::unique_ptr<Catalog> reloaded = Catalog::Load(catalogPath); // throws runtime errors
+                std::size_t count = reloaded->graph.size();
+                published.Publish(std::move(reloaded));
+                auto took = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+                std::cerr << "Reloaded " << count << " courses from " << catalogPath << " in " << took.count() << " ms." << std::endl;
+            }
+            catch (std::runtime_error& e) { // a bad file leaves the catalog being served alone
+                std::cerr << e.what() << std::endl;
+            }
+        });
+
+        std::cerr << "Serving " << courseCount << " courses on " << socketPath << " with " << server.WorkerCount() << " workers, Ctrl+C stops, SIGHUP reloads." << std::endl;
+        server.Run(); // throws runtime errors
+        std::cerr << "Stopped." << std::endl;
+    }
+    catch (std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// get the file path from user and load it
 void LoadDataStructure() {
+    LoadDataStructure(getFilePath());
+}
+
+// build a new catalog from a csv or snapshot file (see Catalog::Load) and publish it
+void LoadDataStructure(const std::string& filePath) {
 
     try {
-        auto csv = CSVFileReader(getFilePath()); // throws runtime errors
-        buildCourses(validate(csv)); // throws also runtime errors
-        std::cout << csv.getFilePath() << " loaded successfully!" << std::endl;
-        csv.CloseFile();
+        // built off to the side, so a bad file leaves the catalog already loaded alone
+        std::unique_ptr<Catalog> loaded = Catalog::Load(filePath); // throws runtime errors
+
+#ifdef COURSEPLANNER_HASH_INDEX
+        std::cout << "Hash index: " << loaded->courses.HashIndexBytes() / 1024 << " KB for " << loaded->graph.size() << " courses." << std::endl;
+#endif
+
+        published.Publish(std::move(loaded)); // the old catalog goes once nothing has it pinned
+        spare.reset(); // a copy of the old catalog, no use now
+
+        std::cout << filePath << " loaded successfully!" << std::endl;
     }
     catch (std::runtime_error e) { // the errors describe where the function failed
         std::cout << e.what() << std::endl;
     }
 }
 
+// add, replace and delete courses as a change file says (see CatalogChanges in Catalog.h), taking turns with the spare
+void ApplyChanges() {
+
+    {
+        auto pinned = console.Pin();
+        if (pinned->isEmpty()) {
+            std::cout << "No courses to change. Please load courses first." << std::endl;
+            return;
+        }
+        if (spare == nullptr) spare = pinned->Clone();
+    } // let go before Exchange, it waits for every reader pinned to the catalog it swaps out
+
+    std::string filePath = getFilePath();
+    try {
+        CatalogChanges changes = CatalogChanges::Read(filePath); // throws runtime errors
+
+        spare->Apply(changes); // throws runtime errors, and then the spare is as it was
+        std::unique_ptr<Catalog> old = published.Exchange(std::move(spare));
+        old->Apply(changes); // the same changes to the same catalog, they fit this one too
+        spare = std::move(old);
+
+        std::cout << filePath << " applied successfully! (" << changes.changes.size() << " change(s))" << std::endl;
+    }
+    catch (std::runtime_error& e) {
+        std::cout << e.what() << std::endl;
+    }
+}
+
 // get a file path from the user as a string with no restrictions
 std::string getFilePath() {
     std::string filePath;
@@ -148,27 +361,42 @@ std::string getFilePath() {
     return filePath;
 }
 
-// populates the data structure with course objects from the validated file
-void buildCourses(std::vector<Course> coursesVec) {
+// save the loaded courses as a binary snapshot, loading that later skips parsing and validating
+void SaveSnapshot() {
 
-    courses.Clear(); //do we want to clear or keeping adding more files??
+    auto pinned = console.Pin(); // this catalog stays put until we return, whatever gets published meanwhile
+    const Catalog& catalog = *pinned;
 
-    //shuffle the input as it typically leads to better tree balance in presorted inputs
-    auto random = std::default_random_engine {};
-    std::shuffle(coursesVec.begin(), coursesVec.end(), random); //linear time
+    if (! catalog.isEmpty()) {
+        std::string filePath;
+        std::cout << "Please enter snapshot file name: ";
+        getline(std::cin, filePath);
 
-    // n                                    log n
-    for (auto course : coursesVec) courses.Insert(course);
+        try {
+            CatalogSnapshot::Write(filePath, catalog.courses); // throws runtime errors
+            std::cout << filePath << " saved successfully!" << std::endl;
+        }
+        catch (std::runtime_error& e) {
+            std::cout << e.what() << std::endl;
+        }
+    }
+    else {
+        std::cout << "No courses to save. Please load courses first." << std::endl;
+    }
 }
 
-// print everything in the data structure
+// print everything in the data structure, one semester at a time so prerequisites always come first
 void PrintCourseList() {
 
-    if (! courses.isEmpty()) {
+    auto pinned = console.Pin();
+    const Catalog& catalog = *pinned;
+
+    if (! catalog.isEmpty()) {
         std::cout << "Here is a sample schedule:\n" << std::endl;
 
-        // all that iterator code in the tree just for this
-        for (auto course : courses) course.Print();
+        std::string list;
+        CatalogQueries::List(catalog, list);
+        std::cout << list;
     }
     else {
         std::cout << "No courses to display. Please load courses first." << std::endl;
@@ -178,22 +406,28 @@ void PrintCourseList() {
 // find a specific course and print its information if available
 void PrintCourse() {
 
-    if (! courses.isEmpty()) {
-        Course search;
+    auto pinned = console.Pin();
+    const Catalog& catalog = *pinned;
+
+    if (! catalog.isEmpty()) {
+        std::string searchID;
         std::cout << "What course do you want to know about? ";
-        getline(std::cin, search.ID);
+        getline(std::cin, searchID);
 
-        /* Return a copy of the object instance in tree
-        if found. if not found, return the search object. Use a blank search object with 
-        just the identifying criteria filled, in this case search.ID
+        /* Find looks the ID up directly (case insensitive, same as the tree ordering) and points 
+        at the course inside the tree, nullptr if not found. Nothing is copied.
         */
-        search = courses.Search(search); // returns course if found or search if not
+        const Course* found = catalog.courses.Find(searchID);
         
-        if (search.Name != "") { // if a search was found, name would be filled on the object
-            search.Print();
-            search.PrintPrereqs();
+        if (found != nullptr) {
+            found->Print();
+            found->PrintPrereqs();
+
+            std::vector<CourseGraph::Handle> all;
+            closuresFor(catalog).Closure(catalog.graph.Find(found->ID())).ForEach([&all](std::size_t prereq) { all.push_back(CourseGraph::Handle(prereq)); });
+            if (all.size() > found->GetPrereqs().size()) std::cout << "Everything required first: " << CatalogQueries::CourseList(catalog, all) << std::endl;
         } else {
-            std::cout << search.ID << " not found." << std::endl;
+            std::cout << searchID << " not found." << std::endl;
         }
     }
     else {
@@ -201,58 +435,118 @@ void PrintCourse() {
     }
 }
 
-// build course objects from file while ensuring that parameters are met in file:
-// 1. at least two values exist on each line (comma seperated)
-// 2. any prerequisites exists as a course (first token of each line) somewhere in the file
-// 3. No empty values
-std::vector<Course> validate(CSVFileReader& csv) {
+// can a student take a course, given the courses they have completed? lists whatever is still missing
+void CheckEligibility() {
+
+    auto pinned = console.Pin();
+    const Catalog& catalog = *pinned;
 
-    std::vector<Course> coursesVec;
-    std::unordered_map<std::string, bool> validCourses;
+    if (! catalog.isEmpty()) {
+        std::string searchID;
+        std::cout << "What course does the student want to take? ";
+        getline(std::cin, searchID);
 
-    while (csv.hasLines()) { // iterate each line of file
+        const Course* wanted = catalog.courses.Find(searchID);
+        if (wanted == nullptr) {
+            std::cout << searchID << " not found." << std::endl;
+            return;
+        }
+
+        std::string completedList;
+        std::cout << "What courses has the student completed (comma separated)? ";
+        getline(std::cin, completedList);
+
+        // same lookup as searching, so IDs can be typed in any case
+        Bitset completed(catalog.graph.size());
+        CSVFileReader csv{ std::string_view(completedList) };
         csv.NextLine();
-        if (!csv.hasTokens()) continue; //skip empty line
+        while (csv.hasTokens()) {
+            std::string_view token = csv.NextToken();
+            token.remove_prefix(std::min(token.find_first_not_of(' '), token.size()));
+            token.remove_suffix(token.size() - (token.find_last_not_of(' ') + 1));
+            if (token.empty()) continue;
+
+            const Course* taken = catalog.courses.Find(token);
+            if (taken != nullptr) completed.Set(catalog.graph.Find(taken->ID()));
+            else std::cout << token << " not found, skipping it." << std::endl;
+        }
 
-        Course newCourse;
+        // a subset test on the bitsets, the closure is cached after the first time
+        CourseGraph::Handle course = catalog.graph.Find(wanted->ID());
+        if (closuresFor(catalog).CanTake(course, completed)) {
+            std::cout << "The student can take " << wanted->ID() << "." << std::endl;
+        } else {
+            std::cout << "The student can not take " << wanted->ID() << " yet. Still needed: "
+                      << CatalogQueries::CourseList(catalog, closuresFor(catalog).Missing(course, completed)) << std::endl;
+        }
+    }
+    else {
+        std::cout << "No courses to check. Please load courses first." << std::endl;
+    }
+}
 
-        // first token
-        newCourse.ID = csv.NextToken();
-        validCourses.emplace(newCourse.ID, true);
+// print the courses that list a course as a prerequisite, and everything further down that depends on it
+void PrintUnlocks() {
 
-        // second token does not exist?
-        if (!csv.hasTokens()) throw std::runtime_error("Error in input file (line " + csv.CurrentLineNumber() +"): Not enough values in line.");
+    auto pinned = console.Pin();
+    const Catalog& catalog = *pinned;
 
-        // second token
-        newCourse.Name = csv.NextToken();
+    if (! catalog.isEmpty()) {
+        std::string searchID;
+        std::cout << "What course do you want to know about? ";
+        getline(std::cin, searchID);
 
-        // -> n remaining tokens to prereqs
-        while (csv.hasTokens()) newCourse.prereqs.push_back(csv.NextToken());
+        const Course* found = catalog.courses.Find(searchID);
+        if (found == nullptr) {
+            std::cout << searchID << " not found." << std::endl;
+            return;
+        }
 
-        // then add the course to the list
-        coursesVec.push_back(newCourse);
-    }
-    checkPrereqs(coursesVec, validCourses); // throws error if invalid
+        // both come from the reverse prerequisite index, only the courses printed get looked at
+        CourseGraph::Handle course = catalog.graph.Find(found->ID());
+        CourseGraph::Handles direct = catalog.graph.Unlocks(course);
+        if (direct.empty()) {
+            std::cout << found->ID() << " is not a prerequisite for anything." << std::endl;
+            return;
+        }
+        std::vector<CourseGraph::Handle> all = catalog.graph.AllUnlocks(course);
 
-    return coursesVec; //if no errors program reaches the return with a validated array of objects ready for insertion
-    // i suppose there can still be nonsense data ("ID: asdasdia") in the objects but is there a good way to validate that?
+        std::cout << found->ID() << " unlocks: " << CatalogQueries::CourseList(catalog, { direct.begin(), direct.end() }) << std::endl;
+        if (all.size() > direct.size()) std::cout << "Everything that builds on it: " << CatalogQueries::CourseList(catalog, all) << std::endl;
+        std::cout << "Retiring " << found->ID() << " would leave " << all.size() << " course(s) impossible to take." << std::endl;
+    }
+    else {
+        std::cout << "No courses to search for. Please load courses first." << std::endl;
+    }
 }
 
-void checkPrereqs(std::vector<Course> coursesVec, std::unordered_map<std::string, bool>& validCourses) {
+// print every course starting with a prefix ("CSCI3") or between two IDs ("MATH100-MATH299", both included)
+void PrintCourseRange() {
 
-    // check each prereq against valid course map
-    // map makes this O(n) for prereqs amount
+    auto pinned = console.Pin();
+    const Catalog& catalog = *pinned;
 
-    int line = 0; //track which line an error may occur. each course object is built from a single line
-    for (auto course : coursesVec) {
-        line++;
-        for (auto prereq : course.prereqs) {
-            if (validCourses.find(prereq) == validCourses.end()) { //if prereq not a valid course
-                throw std::runtime_error("Error in input file (line " + 
-                        std::to_string(line) + "): One or more prerequisites do not exist as a course.");
-            }
-        } //also check for empty values while iterating
-        if (course.ID == "" or course.Name == "") throw std::runtime_error(
-                                "Error in input file (line " + std::to_string(line) + "): Empty value.");
+    if (! catalog.isEmpty()) {
+        std::string query;
+        std::cout << "Enter an ID prefix (like CSCI3) or a range (like MATH100-MATH299): ";
+        getline(std::cin, query);
+
+        std::string found;
+        std::size_t dash = query.find('-');
+        if (dash == std::string::npos) CatalogQueries::Prefix(catalog, query, found);
+        else CatalogQueries::Range(catalog, std::string_view(query).substr(0, dash), std::string_view(query).substr(dash + 1), found);
+        std::cout << found;
+    }
+    else {
+        std::cout << "No courses to display. Please load courses first." << std::endl;
+    }
+}
+
+// the console's closure cache, started over whenever it was last used with a different catalog
+PrereqClosure& closuresFor(const Catalog& catalog) {
+    if (closuresVersion != catalog.Version()) {
+        closures.Reset(catalog.graph);
+        closuresVersion = catalog.Version();
     }
+    return closures;
 }
\ No newline at end of file
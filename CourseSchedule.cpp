@@ -0,0 +1,108 @@
+#include "CourseSchedule.h"
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+static const std::uint32_t NOT_VISITED = 0;
+static const std::uint32_t ON_STACK = 0xFFFFFFFF;
+
+// work out every course's semester, see place
+CourseSchedule::CourseSchedule(const CourseGraph& graph) {
+
+    semesterOf.assign(graph.size(), NOT_VISITED); // becomes the semester once done
+
+    // (course, how many of its prereqs have been looked at)
+    std::vector<std::pair<Handle, std::size_t>> stack;
+    for (Handle start = 0; start < graph.size(); start++) place(graph, start, stack);
+}
+
+/**
+ * @brief Give the changed courses and everything that builds on them their semesters again. Nothing else
+ * can move: a course's semester only depends on the courses below it. Costs those courses and their
+ * prereqs, not the whole graph.
+ *
+ * @param changed courses added, removed or with new prereqs, each once. the graph has its changes already
+ */
+void CourseSchedule::Update(const CourseGraph& graph, const std::vector<Handle>& changed) {
+
+    semesterOf.resize(graph.size(), NOT_VISITED);
+
+    // forget the semesters of the changed courses and then of everything they unlock, breadth first
+    std::vector<Handle> affected;
+    auto forget = [&](Handle course) {
+        if (semesterOf[course] != NOT_VISITED) coursesIn[semesterOf[course]]--;
+        semesterOf[course] = NOT_VISITED;
+        affected.push_back(course);
+    };
+    for (Handle course : changed) forget(course);
+    for (std::size_t i = 0; i < affected.size(); i++) {
+        for (Handle next : graph.Unlocks(affected[i])) {
+            if (semesterOf[next] != NOT_VISITED) forget(next); // not there yet
+        }
+    }
+
+    // same depth first pass as building, it stops at courses that still know their semester
+    std::vector<std::pair<Handle, std::size_t>> stack;
+    for (Handle course : affected) {
+        if (graph.IsCourse(course)) place(graph, course, stack);
+    }
+    while (coursesIn.size() > 1 and coursesIn.back() == 0) coursesIn.pop_back();
+}
+
+/**
+ * @brief Work out the semester of start and of anything below it that isn't done yet.
+ *
+ * Depth first search down the prerequisites with an explicit stack (catalogs can have very long chains,
+ * too long for recursion). A course's semester is known once all its prerequisites are done: one more
+ * than the latest of them, or 1 with no prerequisites. Running into a course that is still on the stack
+ * means the prerequisites loop, and the stack from that course up is the loop.
+ */
+void CourseSchedule::place(const CourseGraph& graph, Handle start, std::vector<std::pair<Handle, std::size_t>>& stack) {
+
+    if (semesterOf[start] != NOT_VISITED) return;
+    stack.clear();
+    stack.emplace_back(start, 0);
+    semesterOf[start] = ON_STACK;
+
+    while (! stack.empty()) {
+
+        Handle course = stack.back().first;
+        CourseGraph::Handles prereqs = graph.Prereqs(course);
+        std::size_t& next = stack.back().second;
+
+        if (next < prereqs.size()) {
+            Handle prereq = prereqs.first[next++];
+
+            if (semesterOf[prereq] == NOT_VISITED) { // go down into it
+                semesterOf[prereq] = ON_STACK;
+                stack.emplace_back(prereq, 0);
+            }
+            else if (semesterOf[prereq] == ON_STACK) { // case: cycle
+                std::string cycle;
+                std::size_t from = stack.size() - 1;
+                while (stack[from].first != prereq) from--;
+                for (std::size_t i = from; i < stack.size(); i++) cycle += std::string(graph.ID(stack[i].first)) + " -> ";
+                cycle += std::string(graph.ID(prereq));
+
+                throw std::runtime_error("Error: prerequisites form a cycle, no schedule is possible (" + cycle +
+                                         ", each course requires the next).");
+            }
+        }
+        else { // all prereqs done, this course goes one semester after the latest of them
+            std::uint32_t semester = 1;
+            for (Handle prereq : prereqs) {
+                if (semesterOf[prereq] + 1 > semester) semester = semesterOf[prereq] + 1;
+            }
+            semesterOf[course] = semester;
+            if (semester >= coursesIn.size()) coursesIn.resize(semester + 1, 0);
+            coursesIn[semester]++;
+            stack.pop_back();
+        }
+    }
+}
+
+void CourseSchedule::Swap(CourseSchedule& other) noexcept {
+    semesterOf.swap(other.semesterOf);
+    coursesIn.swap(other.coursesIn);
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+/*
+==================================================================================================
+Name        :   CourseSchedule.h
+Author      :   Craig O'Loughlin
+Version     :   1
+Date        :   10/16/2026
+
+Description:
+
+    Orders the courses of a CourseGraph so every course comes after its prerequisites, and groups
+    them into semesters: a course goes in the semester after its latest prerequisite (the longest
+    chain of prerequisites leading up to it). Prerequisites that loop back on themselves make a
+    schedule impossible, those are reported with the courses involved.
+
+==================================================================================================
+*/
+
+#ifndef COURSESCHEDULE_H
+#define COURSESCHEDULE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "CourseGraph.h"
+
+/**
+ * @brief Topological order of a course graph in semester layers. Built once per loaded catalog with
+ * a single depth first pass, O(courses + prerequisites), no recursion. After the graph changes, Update
+ * works out again only the changed courses and the ones building on them.
+ *
+ * for (const auto& course : courses)
+ *      semesters[schedule.Semester(graph.Find(course.ID())) - 1].push_back(&course);
+ */
+class CourseSchedule {
+
+    public:
+
+        using Handle = CourseGraph::Handle;
+
+        CourseSchedule() = default;
+        explicit CourseSchedule(const CourseGraph& graph); // throws runtime_error if the prereqs have a cycle
+
+        int SemesterCount() const { return static_cast<int>(coursesIn.size()) - 1; }
+        int Semester(Handle course) const { return static_cast<int>(semesterOf[course]); } // 1 based, 0 for a removed course
+
+        // the graph changed: courses added, removed, or given other prereqs. throws runtime_error on a cycle
+        void Update(const CourseGraph& graph, const std::vector<Handle>& changed);
+
+        void Swap(CourseSchedule& other) noexcept;
+
+    private:
+
+        std::vector<std::uint32_t> semesterOf;      // per handle
+        std::vector<std::size_t> coursesIn = { 0 }; // courses in each semester (index 0 unused), the last one never empty
+
+        void place(const CourseGraph& graph, Handle start, std::vector<std::pair<Handle, std::size_t>>& stack);
+};
+
+#endif
\ No newline at end of file
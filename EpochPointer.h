@@ -0,0 +1,201 @@
+/*
+==================================================================================================
+Name        :   EpochPointer.h
+Author      :   Craig O'Loughlin
+Version     :   1
+Date        :   10/16/2026
+
+Description:
+
+    Publishing a read only object (the loaded catalog) to any number of reader threads without
+    locks. Readers pin whatever is current and use it for as long as they like, a writer swaps
+    in a new object at any time, and the old one is deleted once every reader that could still
+    be looking at it has let go (epoch based reclamation, the same idea as RCU).
+
+==================================================================================================
+*/
+
+#ifndef EPOCHPOINTER_H
+#define EPOCHPOINTER_H
+
+#include <algorithm> // std::min
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread> // std::this_thread::yield
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Atomic pointer to the current T plus a list of retired ones waiting for their readers.
+ *
+ * EpochPointer<Catalog> catalog(std::make_unique<Catalog>());
+ * EpochPointer<Catalog>::Reader reader(catalog);       // once per thread, claims a slot
+ * {
+ *     auto pinned = reader.Pin();                       // lock free: two loads and a store
+ *     pinned->courses.Find(...);                        // good until pinned goes out of scope
+ * }
+ * catalog.Publish(std::make_unique<Catalog>(...));     // from any thread, readers never wait
+ *
+ * How it works: there is a global epoch number. Pinning writes the current epoch into the reader's
+ * slot and then loads the pointer. Publishing swaps the pointer and then bumps the epoch, the old
+ * object is tagged with the epoch it was swapped out in. A reader that could have loaded the old
+ * pointer wrote its slot before the swap, so its slot holds that epoch or an older one; once every
+ * pinned slot is newer than the tag, nobody can be holding the object and it is deleted. Everything
+ * is sequentially consistent, which is what makes "before the swap" mean the same thing to both sides.
+ *
+ * Readers never block and never fail. A reader that stays pinned only delays freeing memory.
+ *
+ * Exchange is Publish for a writer that wants the old object back to change and publish again later
+ * (two copies taking turns, see CoursePlanner.cpp): it waits out the readers instead of retiring it.
+ */
+template <typename T>
+class EpochPointer {
+
+    private:
+
+        static constexpr std::uint64_t IDLE = ~std::uint64_t(0); // slot epoch of a reader not pinned
+
+        // one per reader, each on its own cache line so readers don't slow each other down
+        struct alignas(64) Slot {
+            std::atomic<std::uint64_t> epoch{ IDLE };
+            std::atomic<bool> claimed{ false };
+        };
+
+    public:
+
+        static constexpr std::size_t MAX_READERS = 256;
+
+        // the object pinned by a reader, readable until the guard is destroyed
+        class Guard {
+            public:
+                Guard(Guard&& other) noexcept : object(other.object), slot(other.slot) { other.slot = nullptr; }
+                Guard(const Guard&) = delete;
+                Guard& operator=(const Guard&) = delete;
+                ~Guard() { if (slot != nullptr) slot->store(IDLE); }
+
+                const T& operator*() const { return *object; }
+                const T* operator->() const { return object; }
+
+            private:
+                friend class EpochPointer;
+                Guard(const T* object, std::atomic<std::uint64_t>* slot) : object(object), slot(slot) {}
+                const T* object;
+                std::atomic<std::uint64_t>* slot;
+        };
+
+        // a reader thread's slot. one guard at a time per reader (pinning again while pinned is a bug)
+        class Reader {
+            public:
+                explicit Reader(EpochPointer& pointer);
+                ~Reader() { pointer.slots[slot].claimed.store(false); }
+                Reader(const Reader&) = delete;
+                Reader& operator=(const Reader&) = delete;
+
+                Guard Pin();
+
+            private:
+                EpochPointer& pointer;
+                std::size_t slot;
+        };
+
+        explicit EpochPointer(std::unique_ptr<T> first) : current(first.release()), slots(new Slot[MAX_READERS]) {}
+        ~EpochPointer() { delete current.load(); } // readers (and their guards) have to be gone by now
+        EpochPointer(const EpochPointer&) = delete;
+        EpochPointer& operator=(const EpochPointer&) = delete;
+
+        void Publish(std::unique_ptr<T> next);
+        std::unique_ptr<T> Exchange(std::unique_ptr<T> next); // the old object, once no reader has it pinned
+        std::size_t Reclaim(); // delete whatever no reader can reach any more. returns how many are still waiting
+
+    private:
+
+        std::atomic<T*> current;
+        std::atomic<std::uint64_t> epoch{ 1 };
+        std::unique_ptr<Slot[]> slots;
+
+        std::mutex retireLock; // writers only
+        std::vector<std::pair<std::uint64_t, std::unique_ptr<T>>> retired; // (epoch swapped out in, object)
+};
+
+// claim a free slot. throws runtime_error if MAX_READERS readers already exist
+template <typename T>
+EpochPointer<T>::Reader::Reader(EpochPointer& pointer) : pointer(pointer) {
+    for (slot = 0; slot < MAX_READERS; slot++) {
+        bool expected = false;
+        if (pointer.slots[slot].claimed.compare_exchange_strong(expected, true)) return;
+    }
+    throw std::runtime_error("Error: too many reader threads.");
+}
+
+// announce the epoch we read in, then read the pointer (this order is what Reclaim relies on)
+template <typename T>
+typename EpochPointer<T>::Guard EpochPointer<T>::Reader::Pin() {
+    std::atomic<std::uint64_t>& mine = pointer.slots[slot].epoch;
+    mine.store(pointer.epoch.load());
+    return Guard(pointer.current.load(), &mine);
+}
+
+/**
+ * @brief Make next the object new pins get. Readers pinned already keep the old one, it is deleted
+ * by this or a later Publish/Reclaim once they have all let go.
+ */
+template <typename T>
+void EpochPointer<T>::Publish(std::unique_ptr<T> next) {
+
+    std::unique_ptr<T> old(current.exchange(next.release()));
+    std::uint64_t swappedOutIn = epoch.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> guard(retireLock);
+        retired.emplace_back(swappedOutIn, std::move(old));
+    }
+    Reclaim();
+}
+
+/**
+ * @brief Make next the object new pins get, and hand back the one it replaced once every reader that
+ * could have pinned it has let go. Only the writer waits (readers pinned after the swap see next and
+ * don't hold it up), so the calling thread must not have anything pinned itself.
+ */
+template <typename T>
+std::unique_ptr<T> EpochPointer<T>::Exchange(std::unique_ptr<T> next) {
+
+    std::unique_ptr<T> old(current.exchange(next.release()));
+    std::uint64_t swappedOutIn = epoch.fetch_add(1);
+
+    // same test as Reclaim, for one object: a slot pinned in swappedOutIn or before might have it
+    for (std::size_t slot = 0; slot < MAX_READERS; slot++) {
+        while (slots[slot].epoch.load() <= swappedOutIn) std::this_thread::yield();
+    }
+    return old;
+}
+
+template <typename T>
+std::size_t EpochPointer<T>::Reclaim() {
+
+    std::vector<std::unique_ptr<T>> unreachable; // deleted after unlocking, a catalog can take a while
+    std::size_t waiting;
+    {
+        std::lock_guard<std::mutex> guard(retireLock);
+
+        std::uint64_t oldestPinned = IDLE;
+        for (std::size_t slot = 0; slot < MAX_READERS; slot++) oldestPinned = std::min(oldestPinned, slots[slot].epoch.load());
+
+        auto kept = retired.begin();
+        for (auto& entry : retired) {
+            if (entry.first < oldestPinned) unreachable.push_back(std::move(entry.second));
+            else {
+                if (&*kept != &entry) *kept = std::move(entry);
+                ++kept;
+            }
+        }
+        retired.erase(kept, retired.end());
+        waiting = retired.size();
+    }
+    return waiting;
+}
+
+#endif
\ No newline at end of file
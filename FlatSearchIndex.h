@@ -0,0 +1,358 @@
+/*
+==================================================================================================
+Name        :   FlatSearchIndex.h
+Author      :   Craig O'Loughlin
+Version     :   1
+Date        :   10/16/2026
+
+Description:
+
+    A drop in alternative to BinarySearchTree for catalogs that are loaded once and then mostly
+    searched. Instead of nodes linked by pointers (a likely cache miss for every level walked
+    down) the objects sit in one sorted array, and searches run over a separate array of short
+    fixed size keys laid out in Eytzinger (breadth first heap) order. The top levels of that
+    layout share a handful of cache lines, and the next levels down can be fetched ahead of time.
+
+==================================================================================================
+*/
+
+#ifndef FLATSEARCHINDEX_H
+#define FLATSEARCHINDEX_H
+
+#include <algorithm> // std::stable_sort, std::is_sorted, std::inplace_merge
+#include <cstddef>
+#include <cstdint>
+#include <cstring> // memcmp
+#include <functional> // std::less<>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Sorted array index with the same interface as BinarySearchTree (Insert, Remove, BuildFrom,
+ * Search, Find, iteration, range queries).
+ *
+ * Bulk load (BuildFrom): O(n) from sorted input, O(nlogn) otherwise
+ * Insertion: O(1), the first search after inserting k objects sorts them and merges them in, O(n + klogk)
+ * Removal: O(n), or O(n + klogn) for k keys at once with RemoveEach
+ * Search: O(logn) over the key array, 16 bytes a step, payloads are only touched to break ties
+ * Print all in order: O(n), a straight walk through one array
+ *
+ * Pointers and iterators from it are good until the next Insert/Remove/BuildFrom/Clear (unlike the
+ * tree, where they stay valid). Rebuilds happen inside const searches, so build (any search does it,
+ * or Rebuild()) before sharing one between threads.
+ *
+ * @param T needs T::KEY_SIZE and T::MakeKey(key, char* out) for T and every key type searched with. A
+ *          key is a prefix of the object's identification that memcmp orders the same way Compare
+ *          does, with equal keys broken by Compare (see Course.h).
+ * @param Compare ordering of T, std::less<> (operator<) by default, like the tree.
+ */
+template <typename T, typename Compare = std::less<>>
+class FlatSearchIndex {
+
+    private:
+
+        static constexpr std::size_t KEY_SIZE = T::KEY_SIZE;
+        struct Key { char bytes[KEY_SIZE]; };
+
+        /* items is sorted (once built), and everything searches use is kept apart from it:
+            keys[1 .. n]      keys in Eytzinger order, keys[k]'s children are keys[2k] and keys[2k + 1]
+            itemOf[1 .. n]    index in items of the object keys[k] came from
+        Slot 0 is unused so the child math stays that simple. Insert only appends to items and marks
+        it dirty, the next search sorts what was appended, merges it in and lays the keys out again.
+        Remove takes the object out of items (still sorted) and leaves the layout to that search too.
+        */
+        mutable std::vector<T> items;
+        mutable std::vector<Key> keys;
+        mutable std::vector<std::uint32_t> itemOf;
+        mutable std::size_t sorted = 0; // items before this are in order, the rest were appended since
+        mutable bool dirty = false;
+        Compare lessThan;
+
+        void ensureBuilt() const { if (dirty) build(false); }
+        void build(bool presorted) const;
+        std::size_t layOut(std::size_t slot, std::size_t next) const;
+        template <typename K>
+        std::size_t lowerBoundIndex(const K& key) const;
+        template <typename K>
+        std::size_t upperBoundIndex(const K& key) const;
+
+    public:
+
+        FlatSearchIndex() = default;
+        FlatSearchIndex(FlatSearchIndex&& other) noexcept { Swap(other); }
+        FlatSearchIndex& operator=(FlatSearchIndex&& other) noexcept { Swap(other); return *this; }
+        void Swap(FlatSearchIndex& other) noexcept;
+        void Insert(const T& data) { Emplace(data); }
+        void Insert(T&& data) { Emplace(std::move(data)); }
+        template <typename... Args>
+        const T& Emplace(Args&&... args); // good until the next search (that sorts the array)
+        template <typename K>
+        bool Remove(const K& key);
+        template <typename Iter>
+        std::size_t RemoveEach(Iter first, Iter last); // Remove for every key in [first, last), returns how many went
+        template <typename Iter>
+        void BuildFrom(Iter first, Iter last, bool presorted = false);
+        void Rebuild() const { ensureBuilt(); }
+        T Search(T searchData) const;
+        template <typename K>
+        const T* Find(const K& key) const;
+        void Clear();
+        bool isEmpty() const { return items.empty(); }
+        std::size_t size() const { return items.size(); }
+
+        // walks the sorted array, same use as the tree's iterator
+        struct Flat_Iterator {
+
+            using iterator_category = std::forward_iterator_tag;
+            using difference_type = std::ptrdiff_t;
+            using value_type = T;
+            using pointer = const T*;
+            using reference = const T&;
+
+            Flat_Iterator(const T* item = nullptr) { current = item; }
+            const T& operator*() const { return *current; }
+            const T* operator->() const { return current; }
+            Flat_Iterator& operator++() { current++; return *this; }
+            Flat_Iterator operator++(int) {
+                Flat_Iterator before = *this;
+                current++;
+                return before;
+            }
+
+            friend bool operator==(const Flat_Iterator& lhs, const Flat_Iterator& rhs) { return lhs.current == rhs.current; }
+            friend bool operator!=(const Flat_Iterator& lhs, const Flat_Iterator& rhs) { return lhs.current != rhs.current; }
+
+            private:
+                const T* current;
+        };
+
+        Flat_Iterator begin() const { ensureBuilt(); return Flat_Iterator(items.data()); }
+        Flat_Iterator end() const { ensureBuilt(); return Flat_Iterator(items.data() + items.size()); }
+        Flat_Iterator cbegin() const { return begin(); }
+        Flat_Iterator cend() const { return end(); }
+
+        struct IteratorRange {
+            Flat_Iterator first;
+            Flat_Iterator last;
+            Flat_Iterator begin() const { return first; }
+            Flat_Iterator end() const { return last; }
+            bool empty() const { return first == last; }
+        };
+
+        template <typename K>
+        Flat_Iterator LowerBound(const K& key) const { return Flat_Iterator(items.data() + lowerBoundIndex(key)); }
+        template <typename K>
+        Flat_Iterator UpperBound(const K& key) const { return Flat_Iterator(items.data() + upperBoundIndex(key)); }
+        template <typename K>
+        IteratorRange EqualRange(const K& key) const { return { LowerBound(key), UpperBound(key) }; }
+        template <typename K>
+        IteratorRange Range(const K& low, const K& high) const { // both ends included, empty if high < low
+            Flat_Iterator first = LowerBound(low); // the keys can't be compared with each other directly (IDs ignore case, strings don't)
+            if (first == end() or lessThan(high, *first)) return { end(), end() };
+            return { first, UpperBound(high) };
+        }
+        template <typename P>
+        IteratorRange Prefix(const P& prefix) const { return EqualRange(typename T::PrefixKey(prefix)); }
+};
+
+/**
+ * @brief Add a data object, constructed in place from args (a T, or arguments for one of T's
+ * constructors). It goes on the end and the index is rebuilt before the next search, so loading n
+ * objects with Insert still costs one sort, not n shifts of the array.
+ */
+template <typename T, typename Compare>
+template <typename... Args>
+const T& FlatSearchIndex<T, Compare>::Emplace(Args&&... args) {
+    if (items.size() >= 0xFFFFFFFFull) throw std::runtime_error("Error: too many objects for the index.");
+    items.emplace_back(std::forward<Args>(args)...);
+    dirty = true;
+    return items.back();
+}
+
+/**
+ * @brief Remove one data object matching key. Uses operator<.
+ * @return true if an object was found and removed
+ */
+template <typename T, typename Compare>
+template <typename K>
+bool FlatSearchIndex<T, Compare>::Remove(const K& key) {
+
+    std::size_t index = lowerBoundIndex(key);
+    if (index == items.size() or lessThan(key, items[index])) return false;
+
+    items.erase(items.begin() + index); // still sorted, only the keys need laying out again
+    sorted = items.size();
+    dirty = true;
+    return true;
+}
+
+/**
+ * @brief Remove one data object matching each key in [first, last). Every match is found first and
+ * the array is closed up over all of them in one pass, so it costs one Remove, not k of them.
+ * @return how many objects were found and removed
+ */
+template <typename T, typename Compare>
+template <typename Iter>
+std::size_t FlatSearchIndex<T, Compare>::RemoveEach(Iter first, Iter last) {
+
+    std::vector<std::size_t> found;
+    for (; first != last; ++first) {
+        std::size_t index = lowerBoundIndex(*first);
+        if (index != items.size() and ! lessThan(*first, items[index])) found.push_back(index);
+    }
+    if (found.empty()) return 0;
+    std::sort(found.begin(), found.end());
+    found.erase(std::unique(found.begin(), found.end()), found.end()); // the same key twice still removes one
+
+    std::size_t kept = found[0];
+    std::size_t next = 0; // in found
+    for (std::size_t index = found[0]; index < items.size(); index++) {
+        if (next < found.size() and found[next] == index) next++;
+        else items[kept++] = std::move(items[index]);
+    }
+    items.erase(items.begin() + kept, items.end());
+    sorted = items.size();
+    dirty = true;
+    return found.size();
+}
+
+/**
+ * @brief Replace the contents with the objects in [first, last), sorted once (skipped if presorted
+ * says they already are) and laid out for searching.
+ */
+template <typename T, typename Compare>
+template <typename Iter>
+void FlatSearchIndex<T, Compare>::BuildFrom(Iter first, Iter last, bool presorted) {
+    Clear();
+    for (; first != last; ++first) items.emplace_back(*first);
+    if (items.size() > 0xFFFFFFFFull) {
+        Clear();
+        throw std::runtime_error("Error: too many objects for the index.");
+    }
+    build(presorted);
+}
+
+/** @brief Get the specified object. Uses operator<.
+ * @return A copy of the data object if found else searchData
+ */
+template <typename T, typename Compare>
+T FlatSearchIndex<T, Compare>::Search(T searchData) const {
+    const T* found = Find(searchData);
+    return (found != nullptr) ? *found : searchData;
+}
+
+/** @brief Look up an object in place, no copies made.
+ * @return pointer to the object if found else nullptr. Valid until the index changes
+ */
+template <typename T, typename Compare>
+template <typename K>
+const T* FlatSearchIndex<T, Compare>::Find(const K& key) const {
+    std::size_t index = lowerBoundIndex(key);
+    if (index == items.size() or lessThan(key, items[index])) return nullptr;
+    return &items[index];
+}
+
+template <typename T, typename Compare>
+void FlatSearchIndex<T, Compare>::Clear() {
+    items.clear();
+    keys.clear();
+    itemOf.clear();
+    sorted = 0;
+    dirty = false;
+}
+
+template <typename T, typename Compare>
+void FlatSearchIndex<T, Compare>::Swap(FlatSearchIndex& other) noexcept {
+    items.swap(other.items);
+    keys.swap(other.keys);
+    itemOf.swap(other.itemOf);
+    std::swap(sorted, other.sorted);
+    std::swap(dirty, other.dirty);
+}
+
+/* Sort the objects if needed and lay out the keys. Only what was appended since the last build gets sorted,
+then it is merged into the sorted front in one pass: a few inserts into a big index cost O(n), not O(nlogn).
+Both steps are stable, so equal objects stay in insertion order like the tree.
+*/
+template <typename T, typename Compare>
+void FlatSearchIndex<T, Compare>::build(bool presorted) const {
+
+    if (! presorted) {
+        auto appended = items.begin() + sorted;
+        if (! std::is_sorted(appended, items.end(), lessThan)) std::stable_sort(appended, items.end(), lessThan);
+        std::inplace_merge(items.begin(), appended, items.end(), lessThan);
+    }
+    sorted = items.size();
+
+    keys.assign(items.size() + 1, Key());
+    itemOf.assign(items.size() + 1, 0);
+    layOut(1, 0);
+    dirty = false;
+}
+
+/* Fill the subtree at 'slot' in order: left subtree, this slot, right subtree. Visiting the slots in
+order hands out the sorted items in order, so the array ends up a complete binary search tree stored
+level by level. Returns the next item to hand out. Recursion only goes as deep as the tree, log n.
+*/
+template <typename T, typename Compare>
+std::size_t FlatSearchIndex<T, Compare>::layOut(std::size_t slot, std::size_t next) const {
+    if (slot >= keys.size()) return next;
+    next = layOut(2 * slot, next);
+    T::MakeKey(items[next], keys[slot].bytes);
+    itemOf[slot] = static_cast<std::uint32_t>(next);
+    return layOut(2 * slot + 1, next + 1);
+}
+
+/* Index of the first object not less than key.
+
+Walk down the Eytzinger array comparing keys only, going right when the slot's key is smaller. There is
+no early exit, so the loop is the same few instructions every level and the branch is easy to turn into
+a conditional move. The slots 4 levels down are fetched while this level is compared (16 keys, 4 cache
+lines). Afterwards, the slot we last went left from is the first key not less than key; strip off the
+trailing right turns plus that last left turn to get back to it.
+
+If that key is bigger than the one searched for, its object is the answer without ever looking at it.
+An equal key doesn't mean an equal object though (long IDs, or the key of a prefix), so then step forward
+past anything Compare still says is less. That only happens for objects sharing the whole key.
+*/
+template <typename T, typename Compare>
+template <typename K>
+std::size_t FlatSearchIndex<T, Compare>::lowerBoundIndex(const K& key) const {
+
+    ensureBuilt();
+
+    Key target;
+    T::MakeKey(key, target.bytes);
+
+    const std::size_t n = items.size();
+    std::size_t slot = 1;
+    while (slot <= n) {
+#if defined(__GNUC__) or defined(__clang__)
+        const char* ahead = reinterpret_cast<const char*>(keys.data() + std::min(16 * slot, n));
+        for (int line = 0; line < 4; line++) __builtin_prefetch(ahead + 64 * line);
+#endif
+        slot = 2 * slot + (std::memcmp(keys[slot].bytes, target.bytes, KEY_SIZE) < 0);
+    }
+    while (slot & 1) slot >>= 1;
+    slot >>= 1;
+
+    if (slot == 0) return n;
+    std::size_t index = itemOf[slot];
+    if (std::memcmp(keys[slot].bytes, target.bytes, KEY_SIZE) != 0) return index; // key alone settles it
+
+    while (index < n and lessThan(items[index], key)) index++;
+    return index;
+}
+
+// index of the first object greater than key. every match is next to the lower bound, step over them
+template <typename T, typename Compare>
+template <typename K>
+std::size_t FlatSearchIndex<T, Compare>::upperBoundIndex(const K& key) const {
+    std::size_t index = lowerBoundIndex(key);
+    while (index < items.size() and ! lessThan(key, items[index])) index++;
+    return index;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,158 @@
+/*
+==================================================================================================
+Name        :   HashIndex.h
+Author      :   Craig O'Loughlin
+Version     :   1
+Date        :   10/16/2026
+
+Description:
+
+    A hash table of pointers to objects that live somewhere else (in BinarySearchTree's nodes),
+    so an exact lookup is one hash and usually one probe instead of a walk down the tree. It
+    only holds addresses, the objects themselves are never copied or owned.
+
+==================================================================================================
+*/
+
+#ifndef HASHINDEX_H
+#define HASHINDEX_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Open addressing (linear probing) table of const T*. Each slot keeps the full hash next to
+ * the pointer, so probing past other keys never touches their objects.
+ *
+ * Insert/Erase/Find: O(1) average, the table stays at most half full
+ *
+ * @param T the objects pointed at
+ * @param Hash hash of T and of every key type looked up with, equal objects (by Compare) must hash equal
+ * @param Compare ordering of T, two objects match when neither is less than the other
+ */
+template <typename T, typename Hash, typename Compare>
+class HashIndex {
+
+    public:
+
+        void Insert(const T* item);
+        void Erase(const T* item); // this exact object, not just an equal one
+        template <typename K>
+        const T* Find(const K& key, const Compare& lessThan) const;
+        void Reserve(std::size_t items);
+        void Clear();
+        void Swap(HashIndex& other) noexcept;
+
+        std::size_t size() const { return count; }
+        std::size_t Bytes() const { return slots.size() * sizeof(Slot); }
+
+    private:
+
+        struct Slot {
+            std::size_t hash;
+            const T* item; // nullptr = empty
+        };
+
+        std::vector<Slot> slots;
+        std::size_t count = 0;
+        Hash hasher;
+
+        void grow(std::size_t minimumSlots);
+        void place(Slot slot);
+};
+
+template <typename T, typename Hash, typename Compare>
+void HashIndex<T, Hash, Compare>::Insert(const T* item) {
+    if ((count + 1) * 2 > slots.size()) grow((count + 1) * 2);
+    place({ hasher(*item), item });
+    count++;
+}
+
+/* Remove the slot holding item. Linear probing needs no tombstones: walk on from the hole and move
+back any entry whose probe run would otherwise be cut by it (its home slot is not cyclically between
+the hole and where it sits now).
+*/
+template <typename T, typename Hash, typename Compare>
+void HashIndex<T, Hash, Compare>::Erase(const T* item) {
+
+    if (slots.empty()) return;
+    std::size_t mask = slots.size() - 1;
+    std::size_t hole = hasher(*item) & mask;
+    while (slots[hole].item != item) {
+        if (slots[hole].item == nullptr) return; // not in here
+        hole = (hole + 1) & mask;
+    }
+    slots[hole].item = nullptr;
+    count--;
+
+    for (std::size_t next = (hole + 1) & mask; slots[next].item != nullptr; next = (next + 1) & mask) {
+        std::size_t home = slots[next].hash & mask;
+        bool reachable = (hole <= next) ? (hole < home and home <= next) : (hole < home or home <= next);
+        if (! reachable) { // it can't be found past the hole any more, move it into the hole
+            slots[hole] = slots[next];
+            slots[next].item = nullptr;
+            hole = next;
+        }
+    }
+}
+
+// any object matching key, nullptr if none
+template <typename T, typename Hash, typename Compare>
+template <typename K>
+const T* HashIndex<T, Hash, Compare>::Find(const K& key, const Compare& lessThan) const {
+
+    if (count == 0) return nullptr;
+    std::size_t hash = hasher(key);
+    std::size_t mask = slots.size() - 1;
+    for (std::size_t slot = hash & mask; slots[slot].item != nullptr; slot = (slot + 1) & mask) {
+        if (slots[slot].hash == hash and ! lessThan(key, *slots[slot].item) and ! lessThan(*slots[slot].item, key)) {
+            return slots[slot].item;
+        }
+    }
+    return nullptr;
+}
+
+// make room for this many objects without growing again
+template <typename T, typename Hash, typename Compare>
+void HashIndex<T, Hash, Compare>::Reserve(std::size_t items) {
+    if (items * 2 > slots.size()) grow(items * 2);
+}
+
+template <typename T, typename Hash, typename Compare>
+void HashIndex<T, Hash, Compare>::Clear() {
+    slots.clear();
+    slots.shrink_to_fit();
+    count = 0;
+}
+
+template <typename T, typename Hash, typename Compare>
+void HashIndex<T, Hash, Compare>::Swap(HashIndex& other) noexcept {
+    slots.swap(other.slots);
+    std::swap(count, other.count);
+}
+
+// resize to the next power of two holding minimumSlots (64 at least) and put every entry back, no rehashing
+template <typename T, typename Hash, typename Compare>
+void HashIndex<T, Hash, Compare>::grow(std::size_t minimumSlots) {
+
+    std::size_t size = (slots.empty()) ? 64 : slots.size();
+    while (size < minimumSlots) size *= 2;
+    if (size == slots.size()) return;
+
+    std::vector<Slot> old(size, Slot{ 0, nullptr });
+    old.swap(slots);
+    for (auto& slot : old) {
+        if (slot.item != nullptr) place(slot);
+    }
+}
+
+template <typename T, typename Hash, typename Compare>
+void HashIndex<T, Hash, Compare>::place(Slot slot) {
+    std::size_t mask = slots.size() - 1;
+    std::size_t at = slot.hash & mask;
+    while (slots[at].item != nullptr) at = (at + 1) & mask;
+    slots[at] = slot;
+}
+
+#endif
\ No newline at end of file
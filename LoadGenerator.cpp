@@ -0,0 +1,184 @@
+/*
+==================================================================================================
+Name        :   LoadGenerator.cpp
+Author      :   Craig O'Loughlin
+Version     :   1
+Date        :   10/16/2026
+
+Description:
+
+    Load test client for the query server (CoursePlanner --serve, see QueryServer.h). Opens a
+    number of connections, each on its own thread sending the commands from a file one after
+    another (round and round, each connection starting at a different line) and waiting for
+    every answer before sending the next. At the end it reports how many queries were answered,
+    queries per second and the p50/p99/max latency of one query.
+
+    Usage: LoadGenerator socket commands [connections = 4] [seconds = 10]
+
+    Built by CMakeLists.txt with the others, or on its own by hand, it needs none of the other files:
+        g++ -std=c++17 -O2 -pthread LoadGenerator.cpp -o LoadGenerator
+
+==================================================================================================
+*/
+
+#include <algorithm> // std::sort
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib> // strtoul
+#include <cstring> // memcpy
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using Clock = std::chrono::steady_clock;
+
+// what one connection did
+struct Result {
+    std::vector<std::uint32_t> latencies; // microseconds, one per answered query
+    std::string error;                    // why it stopped early, if it did
+};
+
+static int connectTo(const std::string& socketPath) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) return -1;
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    int socket = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (socket == -1) return -1;
+    if (::connect(socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1) {
+        ::close(socket);
+        return -1;
+    }
+    return socket;
+}
+
+static bool sendAll(int socket, const std::string& bytes) {
+    std::size_t sent = 0;
+    while (sent < bytes.size()) {
+        ssize_t n = ::send(socket, bytes.data() + sent, bytes.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+static bool readAll(int socket, char* into, std::size_t length) {
+    std::size_t got = 0;
+    while (got < length) {
+        ssize_t n = ::read(socket, into + got, length - got);
+        if (n <= 0) return false;
+        got += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+// frames are a 4 byte little endian length then the text, same as QueryServer.cpp
+static std::string frame(const std::string& text) {
+    std::string bytes;
+    std::uint32_t length = static_cast<std::uint32_t>(text.size());
+    for (int i = 0; i < 4; i++) bytes += static_cast<char>((length >> (8 * i)) & 0xFF);
+    return bytes + text;
+}
+
+static bool readFrame(int socket, std::string& text) {
+    unsigned char header[4];
+    if (! readAll(socket, reinterpret_cast<char*>(header), 4)) return false;
+    std::uint32_t length = header[0] | (header[1] << 8) | (header[2] << 16) | (std::uint32_t(header[3]) << 24);
+    text.resize(length);
+    return length == 0 or readAll(socket, &text[0], length);
+}
+
+// one connection: send, wait for the answer, time it, next command. until the deadline
+static void drive(const std::string& socketPath, const std::vector<std::string>& requests, std::size_t first, Clock::time_point deadline, Result& result) {
+
+    int socket = connectTo(socketPath);
+    if (socket == -1) {
+        result.error = "can't connect to " + socketPath;
+        return;
+    }
+
+    std::string reply;
+    for (std::size_t next = first; Clock::now() < deadline; next = (next + 1) % requests.size()) {
+        auto start = Clock::now();
+        if (! sendAll(socket, requests[next]) or ! readFrame(socket, reply)) {
+            result.error = "the server closed the connection";
+            break;
+        }
+        auto took = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+        result.latencies.push_back(static_cast<std::uint32_t>(took));
+    }
+    ::close(socket);
+}
+
+// the latency below which this fraction of queries were answered, latencies sorted
+static std::uint32_t percentile(const std::vector<std::uint32_t>& latencies, double fraction) {
+    std::size_t at = static_cast<std::size_t>(fraction * (latencies.size() - 1) + 0.5);
+    return latencies[at];
+}
+
+int main(int argc, char* argv[]) {
+
+    if (argc < 3) {
+        std::cerr << "Usage: LoadGenerator socket commands [connections = 4] [seconds = 10]" << std::endl;
+        return 1;
+    }
+    std::string socketPath = argv[1];
+    std::size_t connections = (argc > 3) ? std::strtoul(argv[3], nullptr, 10) : 4;
+    std::size_t seconds = (argc > 4) ? std::strtoul(argv[4], nullptr, 10) : 10;
+    if (connections == 0) connections = 1;
+
+    // every non blank line is a query, framed up front so the timed loop only sends
+    std::ifstream file(argv[2], std::ios::binary);
+    if (! file) {
+        std::cerr << "Error opening file: " << argv[2] << std::endl;
+        return 1;
+    }
+    std::vector<std::string> requests;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (! line.empty() and line.back() == '\r') line.pop_back();
+        if (line.find_first_not_of(" \t") != std::string::npos) requests.push_back(frame(line));
+    }
+    if (requests.empty()) {
+        std::cerr << "No commands in " << argv[2] << std::endl;
+        return 1;
+    }
+
+    std::vector<Result> results(connections);
+    std::vector<std::thread> threads;
+    auto start = Clock::now();
+    auto deadline = start + std::chrono::seconds(seconds);
+    for (std::size_t i = 0; i < connections; i++) {
+        std::size_t first = i * requests.size() / connections; // spread out, so they don't all ask the same thing at once
+        threads.emplace_back(drive, std::cref(socketPath), std::cref(requests), first, deadline, std::ref(results[i]));
+    }
+    for (auto& thread : threads) thread.join();
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<std::uint32_t> latencies;
+    for (auto& result : results) {
+        if (! result.error.empty()) std::cerr << "Error: " << result.error << std::endl;
+        latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+    }
+    if (latencies.empty()) {
+        std::cerr << "No queries were answered." << std::endl;
+        return 1;
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    std::cout << "connections: " << connections << std::endl;
+    std::cout << "queries:     " << latencies.size() << std::endl;
+    std::cout << "qps:         " << static_cast<std::uint64_t>(latencies.size() / elapsed) << std::endl;
+    std::cout << "p50:         " << percentile(latencies, 0.50) << " us" << std::endl;
+    std::cout << "p99:         " << percentile(latencies, 0.99) << " us" << std::endl;
+    std::cout << "max:         " << latencies.back() << " us" << std::endl;
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include "MappedFile.h"
+
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// map the whole file read only. an empty file is "open" with size 0 and no mapping (can't map 0 bytes)
+MappedFile::MappedFile(const std::string& filePath) {
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("Error opening file: " + filePath);
+
+    LARGE_INTEGER fileSize;
+    if (! GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        throw std::runtime_error("Error opening file: " + filePath);
+    }
+    fileHandle = file;
+    length = static_cast<std::size_t>(fileSize.QuadPart);
+    if (length == 0) return;
+
+    mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle != nullptr) mapped = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (mapped == nullptr) {
+        Close();
+        throw std::runtime_error("Error mapping file: " + filePath);
+    }
+#else
+    int fd = open(filePath.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Error opening file: " + filePath);
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 or ! S_ISREG(info.st_mode)) {
+        close(fd);
+        throw std::runtime_error("Error opening file: " + filePath);
+    }
+    length = static_cast<std::size_t>(info.st_size);
+    if (length == 0) {
+        close(fd);
+        return;
+    }
+
+    void* memory = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping keeps its own reference to the file
+    if (memory == MAP_FAILED) {
+        length = 0;
+        throw std::runtime_error("Error mapping file: " + filePath);
+    }
+    mapped = static_cast<const char*>(memory);
+#endif
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+
+    if (this != &other) {
+        Close();
+        std::swap(mapped, other.mapped);
+        std::swap(length, other.length);
+#ifdef _WIN32
+        std::swap(fileHandle, other.fileHandle);
+        std::swap(mappingHandle, other.mappingHandle);
+#endif
+    }
+    return *this;
+}
+
+void MappedFile::AdviseSequential() {
+#ifndef _WIN32
+    if (mapped != nullptr) madvise(const_cast<char*>(mapped), length, MADV_SEQUENTIAL);
+#endif
+}
+
+// unmap. any views into the file are invalid after this
+void MappedFile::Close() {
+
+#ifdef _WIN32
+    if (mapped != nullptr) UnmapViewOfFile(mapped);
+    if (mappingHandle != nullptr) CloseHandle(mappingHandle);
+    if (fileHandle != nullptr) CloseHandle(fileHandle);
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#else
+    if (mapped != nullptr) munmap(const_cast<char*>(mapped), length);
+#endif
+    mapped = nullptr;
+    length = 0;
+}
\ No newline at end of file
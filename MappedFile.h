@@ -0,0 +1,59 @@
+/*
+==================================================================================================
+Name        :   MappedFile.h
+Author      :   Craig O'Loughlin
+Version     :   1
+Date        :   10/16/2026
+
+Description:
+
+    Read only memory mapping of a whole file. The operating system pages the file in as it is
+    touched, so nothing is copied into our own buffers and views into the file stay valid until
+    the mapping is closed. POSIX mmap or Windows file mapping depending on the platform.
+
+==================================================================================================
+*/
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Owns one read only mapping of a file. Move only, unmaps on destruction.
+ */
+class MappedFile {
+
+    private:
+
+        const char* mapped = nullptr;
+        std::size_t length = 0;
+
+#ifdef _WIN32
+        void* fileHandle = nullptr;
+        void* mappingHandle = nullptr;
+#endif
+
+    public:
+
+        MappedFile() = default;
+        explicit MappedFile(const std::string& filePath); // throws runtime_error if it can't be opened
+        ~MappedFile() { Close(); }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        const char* data() const { return mapped; }
+        std::size_t size() const { return length; }
+        std::string_view View() const { return std::string_view(mapped, length); }
+        bool isOpen() const { return mapped != nullptr; }
+
+        void AdviseSequential(); // hint that the file will be read front to back (more read ahead)
+        void Close();
+};
+
+#endif
\ No newline at end of file
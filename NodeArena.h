@@ -0,0 +1,147 @@
+/*
+==================================================================================================
+Name        :   NodeArena.h
+Author      :   Craig O'Loughlin
+Version     :   1
+Date        :   10/16/2026
+
+Description:
+
+    Allocator policies for the tree nodes in BinarySearchTree.h. NodeArena hands out nodes from
+    big contiguous blocks and can give every block back at once, HeapAllocator is the old plain
+    new/delete per node. A policy needs Create(args...), Destroy(object), Release() and a
+    releasesAll flag saying whether Release() really frees everything.
+
+==================================================================================================
+*/
+
+#ifndef NODEARENA_H
+#define NODEARENA_H
+
+#include <algorithm> // std::min
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Slab pool for one type of fixed size object. Objects are carved out of blocks in order, so
+ * nodes built one after another sit next to each other in memory. Destroyed objects go on a free
+ * list to be reused by the next Create.
+ *
+ * Create: O(1) (a new block every so often, block size doubles up to MAX_BLOCK_SIZE)
+ * Destroy: O(1)
+ * Release: O(number of blocks), does NOT run destructors, that part is up to the owner
+ *
+ * @param U the object type to pool
+ */
+template <typename U>
+class NodeArena {
+
+    private:
+
+        // a slot is either a live object or a link in the free list
+        union Slot {
+            Slot* next;
+            alignas(U) unsigned char object[sizeof(U)];
+        };
+
+        static constexpr std::size_t FIRST_BLOCK_SIZE = 64;
+        static constexpr std::size_t MAX_BLOCK_SIZE = 65536;
+
+        std::vector<std::unique_ptr<Slot[]>> blocks;
+        std::size_t blockSize = 0; // slots in the newest block
+        std::size_t used = 0;      // slots handed out of the newest block
+        Slot* freeList = nullptr;
+
+        Slot* takeSlot() {
+
+            if (freeList != nullptr) {
+                Slot* slot = freeList;
+                freeList = slot->next;
+                return slot;
+            }
+
+            if (used == blockSize) { // newest block is full, start another one
+                blockSize = blocks.empty() ? FIRST_BLOCK_SIZE : std::min(blockSize * 2, MAX_BLOCK_SIZE);
+                blocks.emplace_back(new Slot[blockSize]);
+                used = 0;
+            }
+            return &blocks.back()[used++];
+        }
+
+        void returnSlot(Slot* slot) {
+            slot->next = freeList;
+            freeList = slot;
+        }
+
+    public:
+
+        static constexpr bool releasesAll = true;
+
+        NodeArena() = default;
+        NodeArena(const NodeArena&) = delete;
+        NodeArena& operator=(const NodeArena&) = delete;
+
+        // moving hands over every block, the arena moved from is left empty
+        NodeArena(NodeArena&& other) noexcept { *this = std::move(other); }
+        NodeArena& operator=(NodeArena&& other) noexcept {
+            if (this != &other) {
+                blocks = std::move(other.blocks);
+                blockSize = other.blockSize;
+                used = other.used;
+                freeList = other.freeList;
+                other.blocks.clear();
+                other.Release();
+            }
+            return *this;
+        }
+
+        // construct a U in a free slot
+        template <typename... Args>
+        U* Create(Args&&... args) {
+
+            Slot* slot = takeSlot();
+            try {
+                return new (slot->object) U(std::forward<Args>(args)...);
+            }
+            catch (...) {
+                returnSlot(slot);
+                throw;
+            }
+        }
+
+        // destruct one object and put its slot up for reuse
+        void Destroy(U* object) {
+            object->~U();
+            returnSlot(reinterpret_cast<Slot*>(object));
+        }
+
+        // free every block in one go. any objects still in them must have been destructed already
+        void Release() {
+            blocks.clear();
+            blockSize = 0;
+            used = 0;
+            freeList = nullptr;
+        }
+};
+
+/**
+ * @brief Plain new/delete for every object, what the tree did before NodeArena. Release can't free
+ * anything since nothing keeps track of the objects, so the owner has to Destroy each one.
+ */
+template <typename U>
+struct HeapAllocator {
+
+    static constexpr bool releasesAll = false;
+
+    template <typename... Args>
+    U* Create(Args&&... args) { return new U(std::forward<Args>(args)...); }
+
+    void Destroy(U* object) { delete object; }
+
+    void Release() {}
+};
+
+#endif
\ No newline at end of file
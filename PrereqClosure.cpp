@@ -0,0 +1,54 @@
+#include "PrereqClosure.h"
+
+#include <utility>
+
+void PrereqClosure::Reset(const CourseGraph& graph) {
+    this->graph = &graph;
+    cache.clear();
+    cache.resize(graph.size());
+    cachedBytes = 0;
+}
+
+/**
+ * @brief All prerequisites of a course, direct or not, as a bitset of handles.
+ *
+ * Walks down the prerequisites marking each one found. A prerequisite with its own closure cached
+ * already has everything below it worked out, so that closure is OR-ed in (a word at a time) and the
+ * walk doesn't go below it. Only the asked for course's closure is cached, so memory grows with the
+ * questions asked and not with the size of the graph.
+ */
+const Bitset& PrereqClosure::Closure(Handle course) {
+
+    if (cache[course].size() != 0) return cache[course];
+
+    Bitset closure(graph->size());
+    stack.clear();
+    for (Handle prereq : graph->Prereqs(course)) stack.push_back(prereq);
+
+    while (! stack.empty()) {
+        Handle prereq = stack.back();
+        stack.pop_back();
+        if (closure.Test(prereq)) continue; // already reached some other way
+        closure.Set(prereq);
+
+        if (cache[prereq].size() != 0) closure |= cache[prereq];
+        else for (Handle next : graph->Prereqs(prereq)) stack.push_back(next);
+    }
+
+    if (cachedBytes + closure.Bytes() > maxBytes) { // full, start over
+        for (auto& old : cache) old = Bitset();
+        cachedBytes = 0;
+    }
+    cachedBytes += closure.Bytes();
+    cache[course] = std::move(closure);
+    return cache[course];
+}
+
+std::vector<PrereqClosure::Handle> PrereqClosure::Missing(Handle course, const Bitset& completed) {
+
+    std::vector<Handle> missing;
+    Closure(course).ForEach([&](std::size_t prereq) {
+        if (! completed.Test(prereq)) missing.push_back(static_cast<Handle>(prereq));
+    });
+    return missing;
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+/*
+==================================================================================================
+Name        :   PrereqClosure.h
+Author      :   Craig O'Loughlin
+Version     :   1
+Date        :   10/16/2026
+
+Description:
+
+    Everything required before a course, not just its direct prerequisites: the prerequisites,
+    their prerequisites, and so on. Each course's answer is worked out the first time it is asked
+    for and kept as a bitset of course handles, so asking again (or asking about a course that
+    builds on it) doesn't walk the graph again. Also answers whether a student who has completed
+    a set of courses can take a course.
+
+==================================================================================================
+*/
+
+#ifndef PREREQCLOSURE_H
+#define PREREQCLOSURE_H
+
+#include <cstddef>
+#include <vector>
+
+#include "Bitset.h"
+#include "CourseGraph.h"
+
+/**
+ * @brief Lazily memoized transitive prerequisite queries over a CourseGraph. Cached closures take
+ * graph.size() bits each, past maxBytes (MAX_CACHE_BYTES unless given) the cache is dropped and
+ * starts over. Threads with one each should split one budget between them, see QueryServer.cpp.
+ *
+ * PrereqClosure closures(graph);
+ * Bitset completed(graph.size());  completed.Set(...);
+ * if (closures.CanTake(course, completed)) ...
+ */
+class PrereqClosure {
+
+    public:
+
+        using Handle = CourseGraph::Handle;
+
+        static constexpr std::size_t MAX_CACHE_BYTES = std::size_t(256) << 20;
+
+        explicit PrereqClosure(std::size_t maxBytes = MAX_CACHE_BYTES) : maxBytes(maxBytes) {}
+        explicit PrereqClosure(const CourseGraph& graph, std::size_t maxBytes = MAX_CACHE_BYTES) : maxBytes(maxBytes) { Reset(graph); }
+
+        void Reset(const CourseGraph& graph); // forget everything cached, answer for this graph from now on
+
+        // every course required before 'course'. stays valid until the next call that isn't cached
+        const Bitset& Closure(Handle course);
+
+        bool Requires(Handle course, Handle prereq) { return Closure(course).Test(prereq); }
+        bool CanTake(Handle course, const Bitset& completed) { return Closure(course).IsSubsetOf(completed); }
+        std::vector<Handle> Missing(Handle course, const Bitset& completed); // required but not completed
+
+        std::size_t CachedBytes() const { return cachedBytes; }
+
+    private:
+
+        const CourseGraph* graph = nullptr;
+        std::vector<Bitset> cache; // per handle, size 0 until worked out
+        std::size_t cachedBytes = 0;
+        std::size_t maxBytes;
+        std::vector<Handle> stack; // kept between calls so it's only allocated once
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,392 @@
+#include "QueryServer.h"
+
+#include <algorithm> // std::min
+#include <chrono>
+#include <iostream> // reload errors the reload function didn't catch
+#include <stdexcept>
+#include <utility>
+
+#include "CatalogQueries.h"
+#include "PrereqClosure.h"
+
+#ifdef __linux__
+
+#include <cerrno>
+#include <csignal>
+#include <cstring> // strerror, memcpy
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// epoll tags for what isn't a connection. connection ids count up from 0 and never get near these
+static const std::uint64_t LISTENER = ~std::uint64_t(0);
+static const std::uint64_t WAKEUP = LISTENER - 1;
+static const std::uint64_t STOPPER = LISTENER - 2;
+static const std::uint64_t RELOADER = LISTENER - 3;
+
+// the eventfds of the server running, for the signal handlers (writing an eventfd is safe in a handler)
+static int stopFd = -1;
+static int reloadFd = -1;
+
+static void signalEventfd(int fd) {
+    std::uint64_t one = 1;
+    ssize_t written = ::write(fd, &one, sizeof(one));
+    (void)written; // nothing to do about it in a handler
+}
+
+static void onStopSignal(int) {
+    signalEventfd(stopFd);
+}
+
+static void onReloadSignal(int) {
+    signalEventfd(reloadFd);
+}
+
+static std::runtime_error systemError(const std::string& what) {
+    return std::runtime_error("Error: " + what + " failed (" + std::strerror(errno) + ").");
+}
+
+// length first, 4 bytes little endian, then the text
+static void appendFrame(std::string& out, const std::string& text) {
+    std::uint32_t length = static_cast<std::uint32_t>(text.size());
+    for (int i = 0; i < 4; i++) out += static_cast<char>((length >> (8 * i)) & 0xFF);
+    out += text;
+}
+
+static std::uint32_t frameLength(const std::string& in) {
+    std::uint32_t length = 0;
+    for (int i = 0; i < 4; i++) length |= std::uint32_t(static_cast<unsigned char>(in[i])) << (8 * i);
+    return length;
+}
+
+QueryServer::QueryServer(EpochPointer<Catalog>& catalog, const std::string& socketPath, std::size_t workers)
+    : catalog(catalog), socketPath(socketPath), workerCount(workers), jobs(1024) {
+    if (workerCount == 0) workerCount = std::thread::hardware_concurrency();
+    if (workerCount == 0) workerCount = 1;
+    workerCount = std::min(workerCount, EpochPointer<Catalog>::MAX_READERS / 2); // leave slots for everything else reading
+}
+
+QueryServer::~QueryServer() {
+    jobs.Close(); // workers finish what's queued and stop
+    for (auto& worker : workers) worker.join();
+    if (reloading.joinable()) reloading.join(); // a reload can't be stopped halfway, it finishes first
+
+    if (stopFd == stopper) {
+        std::signal(SIGINT, SIG_DFL);
+        std::signal(SIGTERM, SIG_DFL);
+        std::signal(SIGHUP, SIG_DFL);
+        stopFd = -1;
+        reloadFd = -1;
+    }
+    for (auto& entry : connections) ::close(entry.second.socket);
+    for (int fd : { poller, wakeup, stopper, reloader }) {
+        if (fd != -1) ::close(fd);
+    }
+    if (listener != -1) {
+        ::close(listener);
+        ::unlink(socketPath.c_str());
+    }
+}
+
+/**
+ * @brief The event loop. Level triggered, so each event only needs handling as far as it can go
+ * without blocking, whatever is left comes back on the next epoll_wait.
+ */
+void QueryServer::Run() {
+
+    setUp(); // throws runtime errors
+
+    epoll_event events[64];
+    bool running = true;
+    while (running) {
+        int ready = epoll_wait(poller, events, 64, -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue; // a signal, the stopper tells us if it was ours
+            throw systemError("epoll_wait");
+        }
+
+        for (int i = 0; i < ready; i++) {
+            std::uint64_t id = events[i].data.u64;
+            if (id == LISTENER) accept();
+            else if (id == WAKEUP) deliverAnswers();
+            else if (id == STOPPER) running = false;
+            else if (id == RELOADER) startReload();
+            else {
+                if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) read(id);
+                if (events[i].events & EPOLLOUT) write(id); // does nothing if read closed it
+            }
+        }
+    }
+}
+
+// socket, epoll, the two eventfds, the stop signals, then the workers
+void QueryServer::setUp() {
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.empty() or socketPath.size() >= sizeof(address.sun_path)) throw std::runtime_error("Error: socket path " + socketPath + " is empty or too long.");
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    // a socket file left behind by a server that was killed would make bind fail. anything else there is left alone
+    struct stat existing;
+    if (::stat(socketPath.c_str(), &existing) == 0 and S_ISSOCK(existing.st_mode)) ::unlink(socketPath.c_str());
+
+    int made = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (made == -1) throw systemError("socket");
+    if (::bind(made, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1) {
+        ::close(made);
+        throw systemError("bind " + socketPath);
+    }
+    listener = made; // ours to unlink from here on
+    if (::listen(listener, SOMAXCONN) == -1) throw systemError("listen");
+
+    poller = epoll_create1(EPOLL_CLOEXEC);
+    if (poller == -1) throw systemError("epoll_create1");
+    wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    stopper = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    reloader = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeup == -1 or stopper == -1 or reloader == -1) throw systemError("eventfd");
+
+    for (auto watched : { std::make_pair(listener, LISTENER), std::make_pair(wakeup, WAKEUP), std::make_pair(stopper, STOPPER),
+                          std::make_pair(reloader, RELOADER) }) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = watched.second;
+        if (epoll_ctl(poller, EPOLL_CTL_ADD, watched.first, &event) == -1) throw systemError("epoll_ctl");
+    }
+
+    stopFd = stopper;
+    reloadFd = reloader;
+    std::signal(SIGINT, onStopSignal);
+    std::signal(SIGTERM, onStopSignal);
+    std::signal(SIGHUP, onReloadSignal);
+
+    // reader slots are claimed here so running out of them throws before any thread starts
+    for (std::size_t i = 0; i < workerCount; i++) readers.push_back(std::make_unique<EpochPointer<Catalog>::Reader>(catalog));
+    for (auto& reader : readers) workers.emplace_back([this, &reader] { work(*reader); });
+}
+
+/**
+ * @brief A worker: take a request, pin whatever catalog is current, answer, hand the answer back to the
+ * loop. Each worker keeps its own prerequisite closure cache, started over when the catalog changes.
+ */
+void QueryServer::work(EpochPointer<Catalog>::Reader& reader) {
+
+    PrereqClosure closures(PrereqClosure::MAX_CACHE_BYTES / workerCount); // one budget for all of them, not one each
+    std::uint64_t closuresVersion = 0;
+
+    Job job;
+    while (jobs.Pop(job)) {
+        Answer answer{ job.connection, std::string() };
+        {
+            auto pinned = reader.Pin();
+            if (pinned->isEmpty()) {
+                answer.reply = "No courses loaded.\n";
+            }
+            else {
+                // one request going wrong (out of memory, a catalog that breaks its own invariants) gets an
+                // error back instead of taking the whole server down with it
+                try {
+                    if (closuresVersion != pinned->Version()) {
+                        closures.Reset(pinned->graph);
+                        closuresVersion = pinned->Version();
+                    }
+                    CatalogQueries::Run(*pinned, closures, job.request, answer.reply);
+                }
+                catch (std::exception& e) {
+                    answer.reply = "Error: could not answer " + job.request + " (" + e.what() + ")\n";
+                    closuresVersion = 0; // no catalog has version 0, so the next request starts the cache over
+                }
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(answerLock);
+            answers.push_back(std::move(answer));
+        }
+        std::uint64_t one = 1;
+        ssize_t written = ::write(wakeup, &one, sizeof(one));
+        (void)written; // only fails if the counter is about to overflow, and then the loop is awake already
+    }
+}
+
+/**
+ * @brief SIGHUP: run the reload function on a thread of its own, so the loop and the workers go on
+ * serving the old catalog meanwhile. Once it has published, old catalogs are freed as soon as the
+ * workers' pins move off them (each pin only lasts one request).
+ */
+void QueryServer::startReload() {
+
+    std::uint64_t count;
+    ssize_t got = ::read(reloader, &count, sizeof(count)); // resets the eventfd
+    (void)got;
+
+    if (! reload or ! reloadDone.load()) return; // nothing to do, or one is still running
+    if (reloading.joinable()) reloading.join(); // done already, this doesn't wait
+
+    reloadDone.store(false);
+    reloading = std::thread([this] {
+        try {
+            reload();
+        }
+        catch (std::exception& e) { // the old catalog stays published, keep serving it
+            std::cerr << "Reload failed: " << e.what() << std::endl;
+        }
+        while (catalog.Reclaim() != 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        reloadDone.store(true);
+    });
+}
+
+// take every waiting connection, each gets the next id
+void QueryServer::accept() {
+
+    while (true) {
+        int socket = ::accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (socket == -1) return; // EAGAIN: that was all of them. anything else: try again on the next event
+
+        std::uint64_t id = nextConnection++;
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = id;
+        if (epoll_ctl(poller, EPOLL_CTL_ADD, socket, &event) == -1) {
+            ::close(socket);
+            continue;
+        }
+        connections[id].socket = socket;
+    }
+}
+
+// read everything the client has sent, then see if a request is complete
+void QueryServer::read(std::uint64_t id) {
+
+    auto found = connections.find(id);
+    if (found == connections.end()) return;
+    Connection& connection = found->second;
+
+    char buffer[64 * 1024];
+    while (true) {
+        ssize_t got = ::read(connection.socket, buffer, sizeof(buffer));
+        if (got > 0) {
+            connection.in.append(buffer, static_cast<std::size_t>(got));
+            continue;
+        }
+        if (got == -1 and errno == EINTR) continue;
+        if (got == -1 and (errno == EAGAIN or errno == EWOULDBLOCK)) break;
+        close(id); // 0: the client hung up. or an error
+        return;
+    }
+
+    // a client sending far more than it waits for answers to is cut off instead of buffered without end
+    if (connection.in.size() > 4 * (MAX_REQUEST + 4)) {
+        close(id);
+        return;
+    }
+    dispatch(id);
+}
+
+// hand the next complete request to the workers, if this connection doesn't have one there already
+void QueryServer::dispatch(std::uint64_t id) {
+
+    auto found = connections.find(id);
+    if (found == connections.end()) return;
+    Connection& connection = found->second;
+
+    if (connection.busy or connection.in.size() < 4) return;
+    std::uint32_t length = frameLength(connection.in);
+    if (length > MAX_REQUEST) {
+        close(id);
+        return;
+    }
+    if (connection.in.size() < 4 + std::size_t(length)) return; // the rest is still coming
+
+    Job job{ id, connection.in.substr(4, length) };
+    connection.in.erase(0, 4 + std::size_t(length));
+    connection.busy = true;
+    jobs.Push(std::move(job));
+}
+
+// the workers' answers, onto their connections' output. a connection closed meanwhile just loses its answer
+void QueryServer::deliverAnswers() {
+
+    std::uint64_t count;
+    ssize_t got = ::read(wakeup, &count, sizeof(count)); // resets the eventfd
+    (void)got;
+
+    std::vector<Answer> ready;
+    {
+        std::lock_guard<std::mutex> guard(answerLock);
+        ready.swap(answers);
+    }
+
+    for (auto& answer : ready) {
+        auto found = connections.find(answer.connection);
+        if (found == connections.end()) continue;
+        appendFrame(found->second.out, answer.reply);
+        found->second.busy = false;
+        write(answer.connection);
+        dispatch(answer.connection); // the next request may be waiting already
+    }
+}
+
+// write as much of the output as the socket takes, and have epoll say when it takes more
+void QueryServer::write(std::uint64_t id) {
+
+    auto found = connections.find(id);
+    if (found == connections.end()) return;
+    Connection& connection = found->second;
+
+    while (connection.sent < connection.out.size()) {
+        ssize_t sent = ::send(connection.socket, connection.out.data() + connection.sent, connection.out.size() - connection.sent, MSG_NOSIGNAL);
+        if (sent >= 0) {
+            connection.sent += static_cast<std::size_t>(sent);
+            continue;
+        }
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN or errno == EWOULDBLOCK) {
+            if (! connection.writing) watch(id, true);
+            return;
+        }
+        close(id);
+        return;
+    }
+
+    connection.out.clear();
+    connection.sent = 0;
+    if (connection.writing) watch(id, false);
+}
+
+void QueryServer::close(std::uint64_t id) {
+
+    auto found = connections.find(id);
+    if (found == connections.end()) return;
+    epoll_ctl(poller, EPOLL_CTL_DEL, found->second.socket, nullptr);
+    ::close(found->second.socket);
+    connections.erase(found); // a request still with the workers gets dropped in deliverAnswers
+}
+
+// EPOLLIN always, EPOLLOUT only while output is waiting (level triggered, it would fire nonstop otherwise)
+void QueryServer::watch(std::uint64_t id, bool writable) {
+
+    Connection& connection = connections[id];
+    epoll_event event{};
+    event.events = writable ? std::uint32_t(EPOLLIN | EPOLLOUT) : std::uint32_t(EPOLLIN);
+    event.data.u64 = id;
+    epoll_ctl(poller, EPOLL_CTL_MOD, connection.socket, &event);
+    connection.writing = writable;
+}
+
+#else
+
+QueryServer::QueryServer(EpochPointer<Catalog>& catalog, const std::string& socketPath, std::size_t workers)
+    : catalog(catalog), socketPath(socketPath), workerCount(workers), jobs(1) {}
+
+QueryServer::~QueryServer() {}
+
+void QueryServer::Run() {
+    throw std::runtime_error("Error: the query server only runs on Linux (it needs epoll).");
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,138 @@
+/*
+==================================================================================================
+Name        :   QueryServer.h
+Author      :   Craig O'Loughlin
+Version     :   1
+Date        :   10/16/2026
+
+Description:
+
+    Serves catalog queries to other programs on the same machine over a Unix domain socket, so
+    the catalog is loaded once and every script or report job asks the one running process
+    instead of starting its own and loading the file again. Linux only (epoll).
+
+    Protocol: every message either way is a frame, a 4 byte length (unsigned, little endian)
+    followed by that many bytes of text. A request is one command line from CatalogQueries.h
+    (find, list, prefix, range, prereqs, schedule), the reply frame holds its answer, or a line
+    starting "Error:" if answering it threw. Requests on one connection are answered in order,
+    one at a time; open more connections to have more answered at once.
+
+    SIGHUP reloads: the reload function given to OnReload (loading the catalog file again and
+    publishing it) runs on a background thread while the workers go on answering from the old
+    catalog, and they move to the new one from their next request on.
+
+==================================================================================================
+*/
+
+#ifndef QUERYSERVER_H
+#define QUERYSERVER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "BoundedQueue.h"
+#include "Catalog.h"
+#include "EpochPointer.h"
+
+/**
+ * @brief epoll event loop plus a fixed pool of worker threads answering queries against a published
+ * catalog.
+ *
+ * The event loop (the thread calling Run) does all the socket work: accepting, reading requests and
+ * writing replies, never blocking on any one client. Complete requests go to the workers through a
+ * queue. Each worker has its own reader slot on the EpochPointer and pins the current catalog for
+ * each request, so the workers share one catalog with no locks, and a catalog published while serving
+ * is picked up from the next request on. Each worker also keeps its own prerequisite closure cache,
+ * the workers split PrereqClosure::MAX_CACHE_BYTES between them so more workers don't mean more memory.
+ * Answers come back to the loop through a list it is woken up for with an eventfd.
+ *
+ * QueryServer server(published, "/tmp/planner.sock", 4);
+ * server.OnReload([&] { published.Publish(Catalog::Load(path)); });  // optional, for SIGHUP
+ * server.Run();    // until SIGINT or SIGTERM
+ */
+class QueryServer {
+
+    public:
+
+        static constexpr std::size_t MAX_REQUEST = std::size_t(1) << 20; // bigger frames close the connection
+
+        // workers = 0 means one per hardware thread
+        QueryServer(EpochPointer<Catalog>& catalog, const std::string& socketPath, std::size_t workers = 0);
+        ~QueryServer();
+        QueryServer(const QueryServer&) = delete;
+        QueryServer& operator=(const QueryServer&) = delete;
+
+        void Run(); // serve until SIGINT or SIGTERM. throws runtime_error if the socket can't be set up
+
+        // what SIGHUP does, run on a background thread while serving. it publishes to the catalog itself
+        // and reports its own errors; a SIGHUP while a reload is still running is ignored
+        void OnReload(std::function<void()> reload) { this->reload = std::move(reload); }
+
+        std::size_t WorkerCount() const { return workerCount; }
+
+    private:
+
+        struct Job {
+            std::uint64_t connection;
+            std::string request;
+        };
+
+        struct Answer {
+            std::uint64_t connection;
+            std::string reply;
+        };
+
+        struct Connection {
+            int socket = -1;
+            std::string in;        // bytes read, not yet taken as requests
+            std::string out;       // reply frames not yet written
+            std::size_t sent = 0;  // how much of out is written
+            bool busy = false;     // a request is with the workers
+            bool writing = false;  // waiting for the socket to take more (EPOLLOUT on)
+        };
+
+        EpochPointer<Catalog>& catalog;
+        std::string socketPath;
+        std::size_t workerCount;
+
+        int listener = -1;
+        int poller = -1;
+        int wakeup = -1;  // eventfd, the workers' answers are ready
+        int stopper = -1; // eventfd, written by the SIGINT/SIGTERM handler to end Run
+        int reloader = -1; // eventfd, written by the SIGHUP handler
+
+        std::function<void()> reload;
+        std::thread reloading;              // the last reload started, joined before the next
+        std::atomic<bool> reloadDone{ true };
+
+        std::unordered_map<std::uint64_t, Connection> connections; // loop thread only
+        std::uint64_t nextConnection = 0;
+
+        BoundedQueue<Job> jobs;
+        std::vector<std::unique_ptr<EpochPointer<Catalog>::Reader>> readers; // one per worker
+        std::vector<std::thread> workers;
+
+        std::mutex answerLock;
+        std::vector<Answer> answers; // from the workers, waiting for the loop
+
+        void setUp();
+        void work(EpochPointer<Catalog>::Reader& reader);
+        void accept();
+        void read(std::uint64_t id);
+        void dispatch(std::uint64_t id);
+        void deliverAnswers();
+        void startReload();
+        void write(std::uint64_t id);
+        void close(std::uint64_t id);
+        void watch(std::uint64_t id, bool writable);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,246 @@
+#include "SimdKernels.h"
+
+#include <cstdlib> // getenv
+#include <cstring> // strcmp, memcpy
+
+#if defined(__x86_64__) or defined(_M_X64) or defined(__i386__) or defined(_M_IX86)
+#define SIMD_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#define TARGET_SSE2 // MSVC lets any function use any of the intrinsics
+#define TARGET_AVX2
+#else
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+/* ---------------------------------------------------------------------------------------------
+    plain loops, for any processor and for the last few bytes the vector versions leave over
+--------------------------------------------------------------------------------------------- */
+
+static unsigned char foldByte(char c) {
+    return static_cast<unsigned char>(SimdKernels::FoldByte(c));
+}
+
+static void matchMasksScalar(const char* text, std::size_t length, char a, char b, std::uint64_t* masks) {
+    for (std::size_t word = 0; word < SimdKernels::MASK_BYTES / 64; word++) masks[word] = 0;
+    for (std::size_t i = 0; i < length and i < SimdKernels::MASK_BYTES; i++) {
+        if (text[i] == a or text[i] == b) masks[i / 64] |= std::uint64_t(1) << (i % 64);
+    }
+}
+
+/* The vector versions mark whole 64 byte blocks. A short last block is copied into a zeroed buffer
+first so they can always read 64 bytes, whatever they find past length is masked off afterwards.
+*/
+static const char* fullBlock(const char* text, std::size_t length, std::size_t start, char* buffer) {
+    if (start + 64 <= length) return text + start;
+    std::memset(buffer, 0, 64);
+    std::memcpy(buffer, text + start, length - start);
+    return buffer;
+}
+
+static std::uint64_t keepLength(std::uint64_t mask, std::size_t length, std::size_t start) {
+    return (start + 64 <= length) ? mask : mask & ((std::uint64_t(1) << (length - start)) - 1);
+}
+
+static void foldAsciiScalar(const char* in, char* out, std::size_t length) {
+    for (std::size_t i = 0; i < length; i++) out[i] = static_cast<char>(foldByte(in[i]));
+}
+
+static int compareFoldedScalar(const char* lhs, const char* rhs, std::size_t length) {
+    for (std::size_t i = 0; i < length; i++) {
+        unsigned char l = foldByte(lhs[i]);
+        unsigned char r = foldByte(rhs[i]);
+        if (l != r) return (l < r) ? -1 : 1;
+    }
+    return 0;
+}
+
+#ifdef SIMD_X86
+
+/* ---------------------------------------------------------------------------------------------
+    SSE2, 16 bytes a step. Every 64 bit x86 processor has it, older 32 bit ones might not
+--------------------------------------------------------------------------------------------- */
+
+// 'A'-'Z' -> 'a'-'z' for 16 bytes at once. the compares are signed, so bytes >= 0x80 are never in range
+TARGET_SSE2 static __m128i fold16(__m128i bytes) {
+    __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(bytes, _mm_set1_epi8('Z' + 1)));
+    return _mm_or_si128(bytes, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+TARGET_SSE2 static void matchMasksSSE2(const char* text, std::size_t length, char a, char b, std::uint64_t* masks) {
+    const __m128i wantA = _mm_set1_epi8(a);
+    const __m128i wantB = _mm_set1_epi8(b);
+
+    for (std::size_t word = 0; word < SimdKernels::MASK_BYTES / 64; word++) {
+        std::size_t start = word * 64;
+        if (start >= length) { masks[word] = 0; continue; }
+
+        alignas(16) char buffer[64];
+        const char* bytes = fullBlock(text, length, start, buffer);
+        std::uint64_t mask = 0;
+        for (int i = 0; i < 4; i++) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + 16 * i));
+            std::uint64_t found = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, wantA), _mm_cmpeq_epi8(chunk, wantB))));
+            mask |= found << (16 * i);
+        }
+        masks[word] = keepLength(mask, length, start);
+    }
+}
+
+TARGET_SSE2 static void fold16At(const char* in, char* out) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), fold16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in))));
+}
+
+// bit i set if lhs[i] and rhs[i] differ ignoring case, for 16 bytes
+TARGET_SSE2 static unsigned differ16(const char* lhs, const char* rhs) {
+    __m128i l = fold16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs)));
+    __m128i r = fold16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs)));
+    return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(l, r))) ^ 0xFFFFu;
+}
+
+TARGET_SSE2 static void foldAsciiSSE2(const char* in, char* out, std::size_t length) {
+    std::size_t i = 0;
+    for (; i + 16 <= length; i += 16) fold16At(in + i, out + i);
+    foldAsciiScalar(in + i, out + i, length - i);
+}
+
+TARGET_SSE2 static int compareFoldedSSE2(const char* lhs, const char* rhs, std::size_t length) {
+    std::size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        unsigned differ = differ16(lhs + i, rhs + i);
+        if (differ != 0) return compareFoldedScalar(lhs + i + SimdKernels::LowestBit(differ), rhs + i + SimdKernels::LowestBit(differ), 1);
+    }
+    return compareFoldedScalar(lhs + i, rhs + i, length - i);
+}
+
+/* ---------------------------------------------------------------------------------------------
+    AVX2, 32 bytes a step. Compiled for AVX2 one function at a time, only called if the processor has it
+
+    These must not hand their last few bytes to the SSE2 versions. The 256 bit constants are loaded
+    before the first step even for a 10 byte ID, and running the SSE2 functions (compiled without
+    AVX) right after that stalls on the switch between the two, about 150 ns a call, more than the
+    scalar loop takes for the whole ID. The 16 byte helpers inline into these and get compiled for
+    AVX2 with them, so the tails stay on this side.
+--------------------------------------------------------------------------------------------- */
+
+TARGET_AVX2 static __m256i fold32(__m256i bytes) {
+    __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(bytes, _mm256_set1_epi8('A' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), bytes));
+    return _mm256_or_si256(bytes, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+}
+
+TARGET_AVX2 static void matchMasksAVX2(const char* text, std::size_t length, char a, char b, std::uint64_t* masks) {
+    const __m256i wantA = _mm256_set1_epi8(a);
+    const __m256i wantB = _mm256_set1_epi8(b);
+
+    for (std::size_t word = 0; word < SimdKernels::MASK_BYTES / 64; word++) {
+        std::size_t start = word * 64;
+        if (start >= length) { masks[word] = 0; continue; }
+
+        alignas(32) char buffer[64];
+        const char* bytes = fullBlock(text, length, start, buffer);
+        __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes));
+        __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + 32));
+        std::uint64_t lowFound = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(low, wantA), _mm256_cmpeq_epi8(low, wantB))));
+        std::uint64_t highFound = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(high, wantA), _mm256_cmpeq_epi8(high, wantB))));
+        masks[word] = keepLength(lowFound | (highFound << 32), length, start);
+    }
+}
+
+TARGET_AVX2 static void foldAsciiAVX2(const char* in, char* out, std::size_t length) {
+    std::size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), fold32(bytes));
+    }
+    if (i + 16 <= length) {
+        fold16At(in + i, out + i);
+        i += 16;
+    }
+    foldAsciiScalar(in + i, out + i, length - i);
+}
+
+TARGET_AVX2 static int compareFoldedAVX2(const char* lhs, const char* rhs, std::size_t length) {
+    std::size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i l = fold32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i)));
+        __m256i r = fold32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i)));
+        unsigned differ = ~static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(l, r)));
+        if (differ != 0) return compareFoldedScalar(lhs + i + SimdKernels::LowestBit(differ), rhs + i + SimdKernels::LowestBit(differ), 1);
+    }
+    if (i + 16 <= length) {
+        unsigned differ = differ16(lhs + i, rhs + i);
+        if (differ != 0) return compareFoldedScalar(lhs + i + SimdKernels::LowestBit(differ), rhs + i + SimdKernels::LowestBit(differ), 1);
+        i += 16;
+    }
+    return compareFoldedScalar(lhs + i, rhs + i, length - i);
+}
+
+// what the processor (and operating system, for the wider AVX registers) supports
+static SimdKernels::Level detectLevel() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    bool sse2 = (info[3] & (1 << 26)) != 0;
+    bool osSavesAvx = (info[2] & (1 << 27)) != 0 and (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    bool avx2 = osSavesAvx and (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    bool sse2 = __builtin_cpu_supports("sse2");
+    bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+    if (avx2) return SimdKernels::Level::AVX2;
+    if (sse2) return SimdKernels::Level::SSE2;
+    return SimdKernels::Level::Scalar;
+}
+
+#else
+
+static SimdKernels::Level detectLevel() {
+    return SimdKernels::Level::Scalar;
+}
+
+#endif
+
+// pick the kernels once, the first time any of them is called
+const SimdKernels::Table& SimdKernels::table() {
+
+    static const Table chosen = [] {
+        Level level = detectLevel();
+
+        const char* forced = std::getenv("COURSEPLANNER_SIMD");
+        if (forced != nullptr) {
+            if (std::strcmp(forced, "scalar") == 0) level = Level::Scalar;
+            else if (std::strcmp(forced, "sse2") == 0 and level == Level::AVX2) level = Level::SSE2;
+        }
+
+#ifdef SIMD_X86
+        if (level == Level::AVX2) return Table{ level, matchMasksAVX2, foldAsciiAVX2, compareFoldedAVX2 };
+        if (level == Level::SSE2) return Table{ level, matchMasksSSE2, foldAsciiSSE2, compareFoldedSSE2 };
+#endif
+        return Table{ Level::Scalar, matchMasksScalar, foldAsciiScalar, compareFoldedScalar };
+    }();
+    return chosen;
+}
+
+SimdKernels::Level SimdKernels::Active() {
+    return table().level;
+}
+
+const char* SimdKernels::LevelName(Level level) {
+    switch (level) {
+        case Level::AVX2: return "avx2";
+        case Level::SSE2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+void SimdKernels::MatchMasks(const char* text, std::size_t length, char a, char b, std::uint64_t* masks) {
+    table().matchMasks(text, length, a, b, masks);
+}
+
+void SimdKernels::FoldAscii(const char* in, char* out, std::size_t length) {
+    table().foldAscii(in, out, length);
+}
@@ -0,0 +1,94 @@
+/*
+==================================================================================================
+Name        :   SimdKernels.h
+Author      :   Craig O'Loughlin
+Version     :   1
+Date        :   10/16/2026
+
+Description:
+
+    The few byte loops everything else spends its time in (finding commas and newlines while
+    parsing, folding IDs to lowercase while comparing) written to look at 16 or 32 bytes per
+    step with SSE2 or AVX2. Which version runs is picked once, when first used, from what the
+    processor supports; anything that isn't x86 gets plain loops that give the same answers.
+
+==================================================================================================
+*/
+
+#ifndef SIMDKERNELS_H
+#define SIMDKERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/**
+ * @brief Vectorized byte kernels with runtime dispatch. All of them are ASCII only, like the rest of
+ * the case folding in this program: 'A'-'Z' fold to 'a'-'z', every other byte is left alone.
+ *
+ * Setting the environment variable COURSEPLANNER_SIMD to scalar, sse2 or avx2 forces a level (never
+ * above what the processor has), handy for comparing them.
+ */
+class SimdKernels {
+
+    public:
+
+        enum class Level { Scalar, SSE2, AVX2 };
+
+        static Level Active(); // what the kernels below are using
+        static const char* LevelName(Level level);
+
+        // bit i of masks[i / 64] is set if text[i] is a or b. looks at up to MASK_BYTES bytes and always
+        // fills MASK_BYTES / 64 masks, bits past length are 0
+        static constexpr std::size_t MASK_BYTES = 256;
+        static void MatchMasks(const char* text, std::size_t length, char a, char b, std::uint64_t* masks);
+
+        // one byte lowercase, for loops that use each byte as they go (hashing). what the kernels do too
+        static char FoldByte(char c) { return (c >= 'A' and c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c; }
+
+        // out[i] = lowercase in[i]. in and out can be the same buffer
+        static void FoldAscii(const char* in, char* out, std::size_t length);
+
+        // compare length bytes of each, ignoring case. <0, 0, >0 like memcmp (bytes compare as unsigned).
+        // shorter than a vector (most course IDs) there's nothing to vectorize, an inlined loop beats the call
+        static int CompareFolded(const char* lhs, const char* rhs, std::size_t length) {
+            if (length >= 16) return table().compareFolded(lhs, rhs, length);
+            for (std::size_t i = 0; i < length; i++) {
+                unsigned char l = static_cast<unsigned char>(FoldByte(lhs[i]));
+                unsigned char r = static_cast<unsigned char>(FoldByte(rhs[i]));
+                if (l != r) return (l < r) ? -1 : 1;
+            }
+            return 0;
+        }
+
+        // index of the lowest set bit, mask can't be 0. a single instruction, so it's inline
+        static unsigned LowestBit(std::uint64_t mask) {
+#if defined(_MSC_VER) and defined(_M_X64)
+            unsigned long bit;
+            _BitScanForward64(&bit, mask);
+            return bit;
+#elif defined(_MSC_VER)
+            unsigned long bit;
+            if (_BitScanForward(&bit, static_cast<unsigned long>(mask))) return bit;
+            _BitScanForward(&bit, static_cast<unsigned long>(mask >> 32));
+            return bit + 32;
+#else
+            return static_cast<unsigned>(__builtin_ctzll(mask));
+#endif
+        }
+
+    private:
+
+        struct Table {
+            Level level;
+            void (*matchMasks)(const char*, std::size_t, char, char, std::uint64_t*);
+            void (*foldAscii)(const char*, char*, std::size_t);
+            int (*compareFolded)(const char*, const char*, std::size_t);
+        };
+        static const Table& table();
+};
+
+#endif
\ No newline at end of file
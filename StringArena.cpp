@@ -0,0 +1,73 @@
+#include "StringArena.h"
+
+#include <cstdint>
+#include <cstring> // memcpy
+#include <utility>
+
+// copy text into the arena, the view returned points at the copy
+std::string_view StringArena::Copy(std::string_view text) {
+    if (text.empty()) return std::string_view();
+    char* copy = allocate(text.size(), 1);
+    std::memcpy(copy, text.data(), text.size());
+    return std::string_view(copy, text.size());
+}
+
+// copy each text plus one contiguous array of views over the copies (a course's prerequisites)
+const std::string_view* StringArena::CopyAll(const std::vector<std::string_view>& texts) {
+    if (texts.empty()) return nullptr;
+    std::string_view* views = Allocate<std::string_view>(texts.size());
+    for (std::size_t i = 0; i < texts.size(); i++) views[i] = Copy(texts[i]);
+    return views;
+}
+
+/**
+ * @brief Move every block of other into this arena. Views into other stay valid, now owned here. Used
+ * to gather the arenas of text parsed on different threads into the one the catalog keeps.
+ */
+void StringArena::Adopt(StringArena& other) {
+    if (this == &other) return;
+    for (auto& block : other.blocks) blocks.push_back(std::move(block));
+    reserved += other.reserved;
+    other.blocks.clear();
+    other.Clear();
+}
+
+void StringArena::Clear() {
+    blocks.clear();
+    next = nullptr;
+    left = 0;
+    reserved = 0;
+}
+
+void StringArena::Swap(StringArena& other) noexcept {
+    blocks.swap(other.blocks);
+    std::swap(next, other.next);
+    std::swap(left, other.left);
+    std::swap(reserved, other.reserved);
+}
+
+/* Bytes from the newest block, aligned. Anything bigger than a quarter block gets a block of its own
+(next keeps pointing into the block it was in, so that space isn't wasted), otherwise a full block starts a new one.
+*/
+char* StringArena::allocate(std::size_t bytes, std::size_t alignment) {
+
+    std::size_t padding = (alignment - reinterpret_cast<std::uintptr_t>(next) % alignment) % alignment;
+    if (next != nullptr and padding + bytes <= left) {
+        char* start = next + padding;
+        next = start + bytes;
+        left -= padding + bytes;
+        return start;
+    }
+
+    if (bytes > BLOCK_SIZE / 4) { // new[] of char is aligned for any fundamental type
+        blocks.emplace_back(new char[bytes]);
+        reserved += bytes;
+        return blocks.back().get();
+    }
+
+    blocks.emplace_back(new char[BLOCK_SIZE]);
+    reserved += BLOCK_SIZE;
+    next = blocks.back().get() + bytes;
+    left = BLOCK_SIZE - bytes;
+    return blocks.back().get();
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+/*
+==================================================================================================
+Name        :   StringArena.h
+Author      :   Craig O'Loughlin
+Version     :   1
+Date        :   10/16/2026
+
+Description:
+
+    Storage for the text the courses point at (names, prerequisite IDs) and the small arrays of
+    views over it. Everything is copied into big blocks one after another, so a catalog's names
+    take one allocation per block instead of one (plus allocator overhead) per string. Nothing is
+    freed on its own, the whole arena goes at once.
+
+==================================================================================================
+*/
+
+#ifndef STRINGARENA_H
+#define STRINGARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <new> // placement new
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Bump allocator for text and trivially destructible arrays. Blocks never move, so views
+ * into the arena stay valid until Clear() or the arena is destroyed, even when the arena itself is
+ * moved, swapped or Adopt()ed into another one.
+ *
+ * Copy/Allocate: O(length), a new block every BLOCK_SIZE bytes
+ * Adopt: O(blocks), nothing is copied
+ *
+ * StringArena text;
+ * course.SetName(text.Copy(token));
+ */
+class StringArena {
+
+    public:
+
+        static constexpr std::size_t BLOCK_SIZE = std::size_t(64) << 10;
+
+        StringArena() = default;
+        StringArena(const StringArena&) = delete;
+        StringArena& operator=(const StringArena&) = delete;
+        StringArena(StringArena&& other) noexcept { Swap(other); }
+        StringArena& operator=(StringArena&& other) noexcept { Swap(other); return *this; }
+
+        std::string_view Copy(std::string_view text);
+        const std::string_view* CopyAll(const std::vector<std::string_view>& texts); // the texts and an array of views over the copies
+
+        // room for count U's, default constructed
+        template <typename U>
+        U* Allocate(std::size_t count) {
+            static_assert(std::is_trivially_destructible<U>::value, "the arena never runs destructors");
+            U* items = reinterpret_cast<U*>(allocate(count * sizeof(U), alignof(U)));
+            for (std::size_t i = 0; i < count; i++) new (items + i) U();
+            return items;
+        }
+
+        void Adopt(StringArena& other); // take over everything in other, which is left empty
+        void Clear();
+        void Swap(StringArena& other) noexcept;
+
+        std::size_t Bytes() const { return reserved; } // held in blocks, used or not
+
+    private:
+
+        std::vector<std::unique_ptr<char[]>> blocks;
+        char* next = nullptr; // free space left in the newest block
+        std::size_t left = 0;
+        std::size_t reserved = 0;
+
+        char* allocate(std::size_t bytes, std::size_t alignment);
+};
+
+#endif
\ No newline at end of file
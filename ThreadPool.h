@@ -0,0 +1,101 @@
+/*
+==================================================================================================
+Name        :   ThreadPool.h
+Author      :   Craig O'Loughlin
+Version     :   1
+Date        :   10/16/2026
+
+Description:
+
+    Fixed set of worker threads that run submitted tasks in order of submission. Submitting
+    gives back a std::future for the task's result (or the exception it threw).
+
+==================================================================================================
+*/
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Simple worker pool. Threads start in the constructor and wait for work, the destructor
+ * lets them finish everything already queued and joins them.
+ *
+ * auto result = pool.Submit([] { return work(); });
+ * ... result.get()
+ */
+class ThreadPool {
+
+    private:
+
+        std::vector<std::thread> workers;
+        std::queue<std::function<void()>> tasks;
+        std::mutex lock;
+        std::condition_variable taskReady;
+        bool stopping = false;
+
+        // each worker takes the next task off the queue until the pool is stopping and the queue is empty
+        void workLoop() {
+            while (true) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> guard(lock);
+                    taskReady.wait(guard, [this] { return stopping or ! tasks.empty(); });
+                    if (tasks.empty()) return; // stopping, nothing left
+                    task = std::move(tasks.front());
+                    tasks.pop();
+                }
+                task();
+            }
+        }
+
+    public:
+
+        // threads = 0 means one per hardware thread
+        explicit ThreadPool(std::size_t threads = 0) {
+            if (threads == 0) threads = std::thread::hardware_concurrency();
+            if (threads == 0) threads = 1; // hardware_concurrency can't tell
+            for (std::size_t i = 0; i < threads; i++) workers.emplace_back([this] { workLoop(); });
+        }
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                stopping = true;
+            }
+            taskReady.notify_all();
+            for (auto& worker : workers) worker.join();
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        std::size_t size() const { return workers.size(); }
+
+        // queue a task, returns the future for its result
+        template <typename F>
+        auto Submit(F task) -> std::future<decltype(task())> {
+
+            // packaged_task can't be copied, std::function needs copyable, so share it
+            auto packaged = std::make_shared<std::packaged_task<decltype(task())()>>(std::move(task));
+            auto result = packaged->get_future();
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                tasks.emplace([packaged] { (*packaged)(); });
+            }
+            taskReady.notify_one();
+            return result;
+        }
+};
+
+#endif
\ No newline at end of file